@@ -0,0 +1,324 @@
+/*
+ * AsyncTransform.h
+ *
+ * C++20 coroutine API on top of Transform (build option: CONFIG+=transform_coroutines,
+ * which switches the project to c++20 and defines TRANSFORM_COROUTINES).
+ *
+ *     AsyncResult<float, 3> r = co_await engine.process_async(input);
+ *     std::array<float, 3> last = co_await engine.results_async();
+ *
+ * The awaiting coroutine is suspended, the work runs on the engine's internal
+ * executor thread and the coroutine is resumed when its result buffer is
+ * ready. By default it is resumed on the executor thread; setResumer() can
+ * redirect resumption, e.g. back onto an event loop.
+ *
+ * Requests that are awaited concurrently are batched: the executor drains the
+ * whole queue at once, runs the process requests back to back and computes
+ * the final (post-Break) results once for all pending results_async() calls.
+ *
+ * A request can be cancelled through a CancelSource; a request that has not
+ * started yet is then resumed with AsyncStatus::Cancelled without running.
+ * The executor looks for cancelled requests in its queue before it starts
+ * each request, so a cancelled one waits at most for the request running at
+ * that moment, not for everything queued ahead of it. A request that already
+ * ran keeps its status (Done or Failed).
+ *
+ * A process request computes in place in its own result buffer
+ * (Transform::apply()); the engine's own results() buffer is not used.
+ */
+
+#ifndef ___MATH_TRANSFORM_ASYNC_TRANSFORM_H_
+#define ___MATH_TRANSFORM_ASYNC_TRANSFORM_H_
+
+#if defined(TRANSFORM_COROUTINES) && __cplusplus >= 202002L && defined(__cpp_impl_coroutine)
+
+#include "Transform.h"
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+enum class AsyncStatus : u8 {
+    Done,
+    Failed,     // process() rejected the input
+    Cancelled
+};
+
+template<typename ResultType, reg N>
+struct AsyncResult {
+    AsyncStatus status = AsyncStatus::Cancelled;
+    std::array<ResultType, N> results = {};
+
+    inline explicit operator bool() const { return status == AsyncStatus::Done; }
+};
+
+// Cancellation flag shared between the caller and its requests
+class CancelSource {
+public:
+    CancelSource() : m_flag(std::make_shared<std::atomic<bool>>(false)) {}
+
+    inline void cancel() { m_flag->store(true, std::memory_order_release); }
+    inline bool cancelled() const { return m_flag->load(std::memory_order_acquire); }
+    inline std::shared_ptr<std::atomic<bool>> token() const { return m_flag; }
+
+private:
+    std::shared_ptr<std::atomic<bool>> m_flag;
+};
+
+template<reg N, typename ResultType, bool UseFlags = true, typename... Transforms>
+class AsyncTransform {
+public:
+    using Engine = Transform<N, ResultType, UseFlags, Transforms...>;
+    using Result = AsyncResult<ResultType, N>;
+    using Resumer = std::function<void(std::coroutine_handle<>)>;
+
+private:
+    // Queued request, lives inside the awaiter (i.e. in the coroutine frame)
+    struct Request {
+        virtual ~Request() = default;
+        virtual void run(Engine& engine) = 0;
+
+        std::coroutine_handle<> handle;
+        std::shared_ptr<std::atomic<bool>> cancel;
+        Result result;
+        bool wantsResults = false;  // results_async(): filled once per batch
+        Request* next = nullptr;
+
+        inline bool cancelled() const { return cancel && cancel->load(std::memory_order_acquire); }
+    };
+
+    template<typename Input>
+    struct ProcessRequest final : Request {
+        explicit ProcessRequest(Input in) : input(std::move(in)) {}
+
+        // Input straight into the result buffer, then every stage in place there
+        void run(Engine& engine) override {
+            if (!Engine::loadInput(input, this->result.results)) {
+                this->result.status = AsyncStatus::Failed;
+                return;
+            }
+            engine.apply(this->result.results.data(), N);
+            this->result.status = AsyncStatus::Done;
+        }
+
+        Input input;
+    };
+
+    struct ResultsRequest final : Request {
+        ResultsRequest() { this->wantsResults = true; }
+        void run(Engine&) override {}
+    };
+
+    template<typename RequestType>
+    class Awaiter {
+    public:
+        template<typename... Args>
+        Awaiter(AsyncTransform& owner, std::shared_ptr<std::atomic<bool>> cancel, Args&&... args)
+            : m_owner(owner), m_request(std::forward<Args>(args)...) {
+            m_request.cancel = std::move(cancel);
+        }
+
+        inline bool await_ready() const noexcept {
+            return m_request.cancelled();
+        }
+
+        // false (do not suspend) if the engine is shutting down
+        inline bool await_suspend(std::coroutine_handle<> handle) {
+            m_request.handle = handle;
+            return m_owner.enqueue(&m_request);
+        }
+
+        // The executor sets the status; a request that never ran keeps the default, Cancelled
+        inline Result await_resume() {
+            return std::move(m_request.result);
+        }
+
+    private:
+        AsyncTransform& m_owner;
+        RequestType m_request;
+    };
+
+    class ResultsAwaiter {
+    public:
+        ResultsAwaiter(AsyncTransform& owner) : m_awaiter(owner, nullptr) {}
+
+        inline bool await_ready() const noexcept { return false; }
+        inline bool await_suspend(std::coroutine_handle<> handle) { return m_awaiter.await_suspend(handle); }
+        inline std::array<ResultType, N> await_resume() { return m_awaiter.await_resume().results; }
+
+    private:
+        Awaiter<ResultsRequest> m_awaiter;
+    };
+
+public:
+    AsyncTransform() : m_thread([this]() { executorLoop(); }) {}
+
+    explicit AsyncTransform(Transforms... transforms)
+        : m_engine(transforms...), m_thread([this]() { executorLoop(); }) {}
+
+    AsyncTransform(const AsyncTransform&) = delete;
+    AsyncTransform& operator=(const AsyncTransform&) = delete;
+
+    ~AsyncTransform() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_one();
+        m_thread.join();
+    }
+
+    // Where suspended callers are resumed (default: on the executor thread)
+    inline void setResumer(Resumer resumer) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_resumer = std::move(resumer);
+    }
+
+    // Runs process() + results() on the executor, input is copied into the request
+    template<typename Input>
+    inline auto process_async(Input input, const CancelSource* cancel = nullptr) {
+        return Awaiter<ProcessRequest<Input>>(*this, cancel ? cancel->token() : nullptr, std::move(input));
+    }
+
+    // Final results of the last processed frame
+    inline auto results_async() {
+        return ResultsAwaiter(*this);
+    }
+
+    // Direct access to the stage objects; only safe while no request is pending.
+    // Its results() buffer does not hold the async frames.
+    inline Engine& engine() { return m_engine; }
+
+private:
+    // False once the engine is stopping: the request stays Cancelled and the caller is not suspended
+    inline bool enqueue(Request* request) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stop) {
+                return false;
+            }
+            *m_tail = request;
+            m_tail = &request->next;
+        }
+        m_wake.notify_one();
+        return true;
+    }
+
+    inline void resume(const Resumer& resumer, Request* request) {
+        if (resumer) {
+            resumer(request->handle);
+        } else {
+            request->handle.resume();
+        }
+    }
+
+    // Moves the cancelled requests of the list at link onto cancelled, returns the list's last link
+    static Request** takeCancelled(Request** link, Request*& cancelled) {
+        while (*link != nullptr) {
+            Request* request = *link;
+            if (request->cancelled()) {
+                *link = request->next;
+                request->next = cancelled;
+                cancelled = request;
+            } else {
+                link = &request->next;
+            }
+        }
+        return link;
+    }
+
+    // Takes the cancelled requests out of the rest of the batch and the queue and resumes them now
+    void resumeCancelled(const Resumer& resumer, Request** rest) {
+        Request* cancelled = nullptr;
+        takeCancelled(rest, cancelled);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tail = takeCancelled(&m_head, cancelled);
+        }
+
+        while (cancelled != nullptr) {
+            Request* next = cancelled->next;
+            cancelled->result.status = AsyncStatus::Cancelled;
+            resume(resumer, cancelled);
+            cancelled = next;
+        }
+    }
+
+    void executorLoop() {
+        for (;;) {
+            Request* batch = nullptr;
+            Resumer resumer;
+            bool stop = false;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [this]() { return m_head != nullptr || m_stop; });
+                batch = m_head;
+                m_head = nullptr;
+                m_tail = &m_head;
+                resumer = m_resumer;
+                stop = m_stop;
+            }
+
+            // Run the whole batch; the last frame is kept once for results_async()
+            const std::array<ResultType, N>* last = nullptr;
+            for (Request** link = &batch; *link != nullptr; link = &(*link)->next) {
+                if (!stop) {
+                    resumeCancelled(resumer, link);
+                    if (*link == nullptr) {
+                        break;
+                    }
+                }
+                Request* request = *link;
+                if (stop) {
+                    request->result.status = AsyncStatus::Cancelled;
+                } else if (!request->wantsResults) {
+                    request->run(m_engine);
+                    if (request->result.status == AsyncStatus::Done) {
+                        last = &request->result.results;
+                    }
+                } else {
+                    if (last != nullptr) {
+                        m_shared = *last;
+                        last = nullptr;
+                    }
+                    request->result.results = m_shared;
+                    request->result.status = AsyncStatus::Done;
+                }
+            }
+            if (last != nullptr) {
+                m_shared = *last;
+            }
+
+            // Resume afterwards: a resumed coroutine may destroy its request
+            for (Request* request = batch; request;) {
+                Request* next = request->next;
+                resume(resumer, request);
+                request = next;
+            }
+
+            if (stop) {
+                return;
+            }
+        }
+    }
+
+private:
+    Engine m_engine;
+    std::array<ResultType, N> m_shared = {};   // last frame, for results_async()
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    Request* m_head = nullptr;
+    Request** m_tail = &m_head;
+    Resumer m_resumer;
+    bool m_stop = false;
+
+    std::thread m_thread; // started last, after every member it uses
+};
+
+#endif /* defined(TRANSFORM_COROUTINES) && __cplusplus >= 202002L && defined(__cpp_impl_coroutine) */
+
+#endif /* ___MATH_TRANSFORM_ASYNC_TRANSFORM_H_ */
@@ -0,0 +1,295 @@
+/*
+ * AutoTuner.h
+ *
+ * Picks the fastest ExecStrategy for a concrete Transform type.
+ *
+ * Every strategy the pipeline supports is timed on a copy of the transform
+ * (process() + results() on a synthetic frame, best of several batches) and
+ * the winner is set on the transform. The choice is stored in a small text
+ * cache file, one line per pipeline and CPU:
+ *
+ *     <cpu model> TAB <pipeline signature> TAB <strategy> TAB <ns per frame>
+ *
+ * so later runs on the same machine read it back instead of tuning again.
+ * Running with retune = true (e.g. from an offline tuning tool) measures
+ * again and replaces that line; the file is rewritten (through a temporary
+ * file and rename()), so it holds one line per key and does not grow.
+ *
+ * The signature is typeid(TransformType).name(): it changes with N,
+ * ResultType and the stage list, but it is implementation-defined, so the
+ * same pipeline has a different key under another compiler or standard
+ * library. Such a cache is not wrong, only missed, and the pipeline is tuned
+ * again.
+ *
+ * autoTune() does not attach a worker pool. Threaded and Tiled are measured
+ * only when the transform already has one (attachParallel()); without it
+ * they are skipped, and nothing is written to the cache, since the result
+ * is not a choice among all strategies.
+ *
+ *     Transform<1 << 18, float, true, Multiply, Add> transform(Multiply(2.0f), Add(1.0f));
+ *     attachParallel(transform);
+ *     autoTune(transform);   // or autoTune(transform, "tuning.txt", true)
+ */
+
+#ifndef ___MATH_TRANSFORM_AUTO_TUNER_H_
+#define ___MATH_TRANSFORM_AUTO_TUNER_H_
+
+#include "Transform.h"
+#include "TransformParallel.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif /* defined(__x86_64__) || defined(__i386__) */
+
+// Candidate strategies, in the order they are measured
+inline constexpr ExecStrategy TunedStrategies[] = {
+    ExecStrategy::PerStage,
+    ExecStrategy::Fused,
+    ExecStrategy::Threaded,
+    ExecStrategy::Tiled
+};
+
+inline const char* strategyName(ExecStrategy strategy) {
+    switch (strategy) {
+    case ExecStrategy::PerStage: return "per-stage";
+    case ExecStrategy::Fused:    return "fused";
+    case ExecStrategy::Threaded: return "threaded";
+    case ExecStrategy::Tiled:    return "tiled";
+    }
+    return "unknown";
+}
+
+// false if the name is not a known strategy
+inline bool strategyFromName(const std::string& name, ExecStrategy& strategy) {
+    for (const ExecStrategy candidate : TunedStrategies) {
+        if (name == strategyName(candidate)) {
+            strategy = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+struct TuneResult {
+    ExecStrategy strategy = ExecStrategy::PerStage;
+    f64 nanoseconds = 0.0;  // per frame, process() + results()
+    bool cached = false;    // true if read from the cache file
+};
+
+namespace tuner_detail {
+
+inline std::string trim(const std::string& text) {
+    const std::size_t begin = text.find_first_not_of(" \t");
+    if (begin == std::string::npos) {
+        return std::string();
+    }
+    const std::size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+inline std::string cpuModel() {
+#if defined(__x86_64__) || defined(__i386__)
+    // Brand string from cpuid leaves 0x80000002..0x80000004
+    unsigned int regs[12] = {};
+    if (__get_cpuid_max(0x80000000, nullptr) >= 0x80000004) {
+        for (unsigned int leaf = 0; leaf < 3; ++leaf) {
+            __get_cpuid(0x80000002 + leaf, &regs[leaf * 4], &regs[leaf * 4 + 1], &regs[leaf * 4 + 2], &regs[leaf * 4 + 3]);
+        }
+        const std::string brand = trim(std::string(reinterpret_cast<const char*>(regs), sizeof(regs)).c_str());
+        if (!brand.empty()) {
+            return brand;
+        }
+    }
+#endif /* defined(__x86_64__) || defined(__i386__) */
+
+    // Linux on other architectures: first descriptive line of /proc/cpuinfo
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        const std::size_t colon = line.find(':');
+        if (colon == std::string::npos) {
+            continue;
+        }
+        const std::string key = trim(line.substr(0, colon));
+        if (key == "model name" || key == "Hardware" || key == "cpu model" || key == "CPU part") {
+            return trim(line.substr(colon + 1));
+        }
+    }
+    return "unknown";
+}
+
+template<typename TransformType>
+inline std::string signature() {
+    return typeid(TransformType).name();
+}
+
+// true if the line is a cache entry for this CPU and pipeline
+inline bool matches(const std::string& line, const std::string& cpu, const std::string& pipeline) {
+    const std::size_t first = line.find('\t');
+    if (first == std::string::npos) {
+        return false;
+    }
+    const std::size_t second = line.find('\t', first + 1);
+    if (second == std::string::npos) {
+        return false;
+    }
+    return first == cpu.size() && line.compare(0, first, cpu) == 0 &&
+           second - first - 1 == pipeline.size() && line.compare(first + 1, second - first - 1, pipeline) == 0;
+}
+
+// Last cache line for this CPU and pipeline, false if there is none
+inline bool readCache(const std::string& file, const std::string& cpu, const std::string& pipeline, TuneResult& result) {
+    std::ifstream cache(file);
+    std::string line;
+    bool found = false;
+
+    while (std::getline(cache, line)) {
+        if (!matches(line, cpu, pipeline)) {
+            continue;
+        }
+        const std::size_t second = line.find('\t', line.find('\t') + 1);
+        const std::size_t third = line.find('\t', second + 1);
+        if (third == std::string::npos) {
+            continue;
+        }
+
+        ExecStrategy strategy = ExecStrategy::PerStage;
+        if (!strategyFromName(line.substr(second + 1, third - second - 1), strategy)) {
+            continue;
+        }
+        result.strategy = strategy;
+        result.nanoseconds = std::strtod(line.c_str() + third + 1, nullptr);
+        result.cached = true;
+        found = true;
+    }
+    return found;
+}
+
+// Rewrites the cache with this entry in place of any earlier one for the same key
+inline bool writeCache(const std::string& file, const std::string& cpu, const std::string& pipeline, const TuneResult& result) {
+    std::vector<std::string> lines;
+    {
+        std::ifstream cache(file);
+        std::string line;
+        while (std::getline(cache, line)) {
+            if (!line.empty() && !matches(line, cpu, pipeline)) {
+                lines.push_back(line);
+            }
+        }
+    }
+
+    // Written next to the cache and renamed over it: readers never see a partial file
+    const std::string temporary = file + ".tmp";
+    {
+        std::ofstream cache(temporary, std::ios::trunc);
+        for (const std::string& line : lines) {
+            cache << line << '\n';
+        }
+        cache << cpu << '\t' << pipeline << '\t' << strategyName(result.strategy) << '\t' << result.nanoseconds << '\n';
+        if (!cache.flush()) {
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+    if (std::rename(temporary.c_str(), file.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Best time of several batches, in nanoseconds per frame
+template<typename TransformType, typename Input>
+f64 measure(TransformType& transform, const Input& input) {
+    using Clock = std::chrono::steady_clock;
+    constexpr f64 BatchNanoseconds = 2e6;   // ~2 ms per batch
+    constexpr int Batches = 5;
+
+    transform.process(input); // warm-up: page faults, thread start, caches
+    transform.results();
+
+    const auto start = Clock::now();
+    transform.process(input);
+    transform.results();
+    const f64 single = std::chrono::duration<f64, std::nano>(Clock::now() - start).count();
+    const reg repeats = single >= BatchNanoseconds ? 1 : static_cast<reg>(BatchNanoseconds / (single + 1.0)) + 1;
+
+    f64 best = 0.0;
+    for (int batch = 0; batch < Batches; ++batch) {
+        const auto begin = Clock::now();
+        for (reg r = 0; r < repeats; ++r) {
+            transform.process(input);
+            transform.results();
+        }
+        const f64 elapsed = std::chrono::duration<f64, std::nano>(Clock::now() - begin).count() / static_cast<f64>(repeats);
+        if (batch == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+} // namespace tuner_detail
+
+// Sets the fastest strategy on transform (from the cache if present) and returns it.
+// Threaded and Tiled are candidates only if a pool is attached (attachParallel()).
+template<typename TransformType>
+TuneResult autoTune(TransformType& transform, const std::string& cacheFile = "transform_tune.txt", bool retune = false) {
+    const std::string cpu = tuner_detail::cpuModel();
+    const std::string pipeline = tuner_detail::signature<TransformType>();
+    const bool parallel = transform.parallelExecutor() != nullptr;
+
+    // Strategies that can actually run on this transform
+    auto runnable = [parallel](ExecStrategy strategy) {
+        const bool needsPool = strategy == ExecStrategy::Threaded || strategy == ExecStrategy::Tiled;
+        return TransformType::supports(strategy) && (parallel || !needsPool);
+    };
+
+    TuneResult result;
+    if (!retune && tuner_detail::readCache(cacheFile, cpu, pipeline, result) && runnable(result.strategy)) {
+        transform.setStrategy(result.strategy);
+        return result;
+    }
+
+    // Measured on a copy: stages with state must not see the synthetic frames.
+    // Heap copy because the results array of a large transform is stored inline.
+    using ResultArray = std::remove_reference_t<decltype(transform.get_array())>;
+    using ResultType = typename ResultArray::value_type;
+
+    auto probe = std::make_unique<TransformType>(transform);
+    std::vector<ResultType> input(TransformType::DataSize);
+    for (reg i = 0; i < input.size(); ++i) {
+        input[i] = static_cast<ResultType>(i % 97 + 1);
+    }
+
+    result = TuneResult();
+    bool first = true;
+    for (const ExecStrategy strategy : TunedStrategies) {
+        if (!runnable(strategy)) {
+            continue;
+        }
+        probe->setStrategy(strategy);
+        const f64 nanoseconds = tuner_detail::measure(*probe, input);
+        if (first || nanoseconds < result.nanoseconds) {
+            result.strategy = strategy;
+            result.nanoseconds = nanoseconds;
+            first = false;
+        }
+    }
+
+    if (parallel) {
+        tuner_detail::writeCache(cacheFile, cpu, pipeline, result);
+    }
+    transform.setStrategy(result.strategy);
+    return result;
+}
+
+#endif /* ___MATH_TRANSFORM_AUTO_TUNER_H_ */
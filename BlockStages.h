@@ -0,0 +1,324 @@
+/*
+ * BlockStages.h
+ *
+ * Block stages work on the whole buffer instead of one element at a time.
+ * A stage is a block stage when it provides
+ *
+ *     void applyBlock(ResultType* data, reg count);
+ *
+ * Transform calls it in place of the element loop, so block stages share the
+ * same tuple, flags and Break machinery as element stages.
+ *
+ * The stages below are sized by N at compile time: their window and twiddle
+ * tables are generated with constexpr and live in the binary, so the stage
+ * objects themselves carry no per-instance buffers.
+ */
+
+#ifndef ___MATH_TRANSFORM_BLOCK_STAGES_H_
+#define ___MATH_TRANSFORM_BLOCK_STAGES_H_
+
+#include "basic_types.h"
+#include <array>
+#include <cmath>
+
+namespace block_detail {
+
+inline constexpr f64 Pi = 3.14159265358979323846;
+
+// Reduces x to [-pi, pi]
+constexpr f64 reduce(f64 x) {
+    const f64 turns = x / (2.0 * Pi);
+    const f64 whole = static_cast<f64>(static_cast<i64>(turns < 0.0 ? turns - 0.5 : turns + 0.5));
+    return x - whole * 2.0 * Pi;
+}
+
+// constexpr cosine/sine (std::cos/std::sin are not constexpr in C++17)
+constexpr f64 cos(f64 x) {
+    x = reduce(x);
+
+    // cos(x) = -cos(pi - |x|) keeps the series argument within [-pi/2, pi/2]
+    f64 sign = 1.0;
+    const f64 absolute = x < 0.0 ? -x : x;
+    if (absolute > Pi / 2.0) {
+        x = Pi - absolute;
+        sign = -1.0;
+    }
+
+    f64 term = 1.0;
+    f64 sum = 1.0;
+    for (int n = 1; n < 12; ++n) {
+        term *= -x * x / static_cast<f64>((2 * n - 1) * (2 * n));
+        sum += term;
+    }
+    return sign * sum;
+}
+
+constexpr f64 sin(f64 x) {
+    return cos(Pi / 2.0 - x);
+}
+
+constexpr bool isPowerOfTwo(reg n) {
+    return n != 0 && (n & (n - 1)) == 0;
+}
+
+constexpr reg log2(reg n) {
+    reg bits = 0;
+    while ((reg(1) << bits) < n) {
+        ++bits;
+    }
+    return bits;
+}
+
+} // namespace block_detail
+
+enum class WindowKind : u8 {
+    Hann,
+    Hamming,
+    Blackman
+};
+
+template<reg N, typename T, WindowKind Kind>
+constexpr std::array<T, N> makeWindow() {
+    std::array<T, N> table = {};
+    const f64 denominator = (N > 1) ? static_cast<f64>(N - 1) : 1.0;
+
+    for (reg i = 0; i < N; ++i) {
+        const f64 phase = 2.0 * block_detail::Pi * static_cast<f64>(i) / denominator;
+        f64 value = 0.0;
+        if constexpr (Kind == WindowKind::Hann) {
+            value = 0.5 - 0.5 * block_detail::cos(phase);
+        } else if constexpr (Kind == WindowKind::Hamming) {
+            value = 0.54 - 0.46 * block_detail::cos(phase);
+        } else {
+            value = 0.42 - 0.5 * block_detail::cos(phase) + 0.08 * block_detail::cos(2.0 * phase);
+        }
+        table[i] = static_cast<T>(value);
+    }
+    return table;
+}
+
+// Multiplies the frame by a window function
+template<reg N, typename T = float, WindowKind Kind = WindowKind::Hann>
+class WindowFunction {
+public:
+    static constexpr std::array<T, N> Table = makeWindow<N, T, Kind>();
+
+    inline void applyBlock(T* data, reg count) const {
+        const reg size = count < N ? count : N;
+        for (reg i = 0; i < size; ++i) {
+            data[i] *= Table[i];
+        }
+    }
+};
+
+template<reg N, typename T = float>
+using HannWindow = WindowFunction<N, T, WindowKind::Hann>;
+
+template<reg N, typename T = float>
+using BlackmanWindow = WindowFunction<N, T, WindowKind::Blackman>;
+
+// Scales the frame so that its largest absolute value becomes Peak (default 1)
+template<typename T = float>
+class NormalizePeak {
+public:
+    NormalizePeak() = default;
+    explicit NormalizePeak(T peak) : m_peak(peak) {}
+
+    inline void applyBlock(T* data, reg count) const {
+        T peak = T(0);
+        for (reg i = 0; i < count; ++i) {
+            const T value = data[i] < T(0) ? -data[i] : data[i];
+            peak = value > peak ? value : peak;
+        }
+        if (peak == T(0)) {
+            return;
+        }
+
+        const T scale = m_peak / peak;
+        for (reg i = 0; i < count; ++i) {
+            data[i] *= scale;
+        }
+    }
+
+private:
+    T m_peak = T(1);
+};
+
+// FFT magnitude spectrum of an N-point real frame (decimation in time).
+// data[k] = |X[k]| for every k, so bins above N / 2 mirror the lower half.
+// Needs a full frame: applyBlock() asserts count >= N.
+//
+// Computed in place in the frame, without scratch arrays: the real frame is
+// packed into an N / 2-point complex FFT (even samples as real parts, odd
+// samples as imaginary parts, stored as two halves of data[]), and the N-point
+// spectrum is recovered from it pairwise (bins k and N / 2 - k read and write
+// the same four slots). The stage itself is empty; the only table is the
+// constexpr twiddles (N / 2 complex values).
+//
+// The packing is an N-point bit reversal of the frame (sample 2r + p goes to
+// p * N / 2 + reverse(r)), done with in-place swaps computed on the fly.
+// The butterflies run as radix-4 passes (two radix-2 stages per pass over
+// the frame), plus one radix-2 pass first when log2(N / 2) is odd.
+template<reg N, typename T = float>
+class FFTMagnitude {
+    static_assert(block_detail::isPowerOfTwo(N) && N >= 2, "FFT size must be a power of two.");
+
+    static constexpr reg M = N / 2;     // points of the packed complex FFT
+
+    struct Twiddles {
+        std::array<T, N / 2> re = {};
+        std::array<T, N / 2> im = {};
+    };
+
+    static constexpr Twiddles makeTwiddles() {
+        Twiddles table = {};
+        for (reg k = 0; k < N / 2; ++k) {
+            const f64 phase = -2.0 * block_detail::Pi * static_cast<f64>(k) / static_cast<f64>(N);
+            table.re[k] = static_cast<T>(block_detail::cos(phase));
+            table.im[k] = static_cast<T>(block_detail::sin(phase));
+        }
+        return table;
+    }
+
+public:
+    static constexpr Twiddles Twiddle = makeTwiddles();
+
+    void applyBlock(T* data, reg count) const {
+        assert(count >= N && "FFTMagnitude needs a full frame");
+        (void)count;
+
+        permute(data);
+
+        // M-point complex FFT: real parts in data[0, M), imaginary parts in data[M, N)
+        T* re = data;
+        T* im = data + M;
+        reg length = 2;
+        if constexpr (block_detail::log2(M) % 2 == 1) {
+            // Odd stage count: the first stage (all twiddles 1) on its own
+            for (reg a = 0; a < M; a += 2) {
+                const T tr = re[a + 1];
+                const T ti = im[a + 1];
+                re[a + 1] = re[a] - tr;
+                im[a + 1] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+            length = 4;
+        }
+
+        // Stages length and 2 * length in one pass over blocks of 2 * length
+        for (; 2 * length <= M; length <<= 2) {
+            const reg half = length / 2;
+            const reg step = N / length;    // W_length^j = W_N^(j * step)
+            for (reg begin = 0; begin < M; begin += 2 * length) {
+                for (reg j = 0; j < half; ++j) {
+                    const T w1r = Twiddle.re[j * step];
+                    const T w1i = Twiddle.im[j * step];
+                    const T w2r = Twiddle.re[j * step / 2];    // W_(2 length)^j
+                    const T w2i = Twiddle.im[j * step / 2];
+                    const reg a0 = begin + j;
+                    const reg a1 = a0 + half;
+                    const reg a2 = a1 + half;
+                    const reg a3 = a2 + half;
+
+                    // Stage length: (a0, a1) and (a2, a3) with W_length^j
+                    T tr = re[a1] * w1r - im[a1] * w1i;
+                    T ti = re[a1] * w1i + im[a1] * w1r;
+                    const T y0r = re[a0] + tr;
+                    const T y0i = im[a0] + ti;
+                    const T y1r = re[a0] - tr;
+                    const T y1i = im[a0] - ti;
+
+                    tr = re[a3] * w1r - im[a3] * w1i;
+                    ti = re[a3] * w1i + im[a3] * w1r;
+                    const T y2r = re[a2] + tr;
+                    const T y2i = im[a2] + ti;
+                    const T y3r = re[a2] - tr;
+                    const T y3i = im[a2] - ti;
+
+                    // Stage 2 * length: (a0, a2) with W_(2 length)^j,
+                    // (a1, a3) with W_(2 length)^(j + half) = -i W_(2 length)^j
+                    tr = y2r * w2r - y2i * w2i;
+                    ti = y2r * w2i + y2i * w2r;
+                    re[a0] = y0r + tr;
+                    im[a0] = y0i + ti;
+                    re[a2] = y0r - tr;
+                    im[a2] = y0i - ti;
+
+                    const T ur = y3r * w2r - y3i * w2i;
+                    const T ui = y3r * w2i + y3i * w2r;
+                    re[a1] = y1r + ui;
+                    im[a1] = y1i - ur;
+                    re[a3] = y1r - ui;
+                    im[a3] = y1i + ur;
+                }
+            }
+        }
+
+        unpack(data);
+    }
+
+private:
+    // N-point bit reversal by swaps; j follows i with a reversed increment
+    static inline void permute(T* data) {
+        reg j = 0;
+        for (reg i = 0; i < N; ++i) {
+            if (i < j) {
+                const T swapped = data[i];
+                data[i] = data[j];
+                data[j] = swapped;
+            }
+            reg bit = N >> 1;
+            while (bit != 0 && (j & bit) != 0) {
+                j ^= bit;
+                bit >>= 1;
+            }
+            j |= bit;
+        }
+    }
+
+    // X[k] = E[k] + W_N^k O[k], with E/O the spectra of the even/odd samples:
+    // E[k] = (Z[k] + conj(Z[M - k])) / 2, O[k] = (Z[k] - conj(Z[M - k])) / 2j
+    static inline void unpack(T* data) {
+        const T half = T(0.5);
+
+        // Bins 0 and M (Z[0] is real even + real odd sums)
+        const T r0 = data[0];
+        const T i0 = data[M];
+        data[0] = std::abs(r0 + i0);
+        data[M] = std::abs(r0 - i0);
+
+        for (reg k = 1; k <= M / 2; ++k) {
+            const reg b = M - k;
+            const T ar = data[k];
+            const T ai = data[M + k];
+            const T br = data[b];
+            const T bi = data[M + b];
+            const T wr = Twiddle.re[k];
+            const T wi = Twiddle.im[k];
+
+            // Bin k
+            const T er = (ar + br) * half;
+            const T ei = (ai - bi) * half;
+            const T orr = (ai + bi) * half;
+            const T oi = (br - ar) * half;
+            const T xr = er + wr * orr - wi * oi;
+            const T xi = ei + wr * oi + wi * orr;
+
+            // Bin M - k: E and O conjugated, W_N^(M - k) = -conj(W_N^k)
+            const T yr = er - wr * orr + wi * oi;
+            const T yi = wr * oi + wi * orr - ei;
+
+            const T magnitude = static_cast<T>(std::sqrt(xr * xr + xi * xi));
+            const T mirrored = static_cast<T>(std::sqrt(yr * yr + yi * yi));
+
+            // The four slots read above, bins above N / 2 mirror the lower half
+            data[k] = magnitude;
+            data[N - k] = magnitude;
+            data[b] = mirrored;
+            data[M + k] = mirrored;
+        }
+    }
+};
+
+#endif /* ___MATH_TRANSFORM_BLOCK_STAGES_H_ */
@@ -0,0 +1,141 @@
+/*
+ * CacheInfo.h
+ *
+ * Data cache sizes of the current CPU, used to size cache-blocked tiles.
+ *
+ * On Linux the sizes are read once from sysfs
+ * (/sys/devices/system/cpu/cpu0/cache/index*). Other targets (and Linux
+ * builds with TRANSFORM_CACHE_SYSFS=0) use the compile-time values below,
+ * which a build can override: -DTRANSFORM_CACHE_L2=1048576. They are also
+ * kept when sysfs is not readable.
+ *
+ * Host-only: included by TransformParallel.h, not by Transform.h.
+ */
+
+#ifndef ___MATH_TRANSFORM_CACHE_INFO_H_
+#define ___MATH_TRANSFORM_CACHE_INFO_H_
+
+#include "basic_types.h"
+
+#ifndef TRANSFORM_CACHE_SYSFS
+#if defined(__linux__)
+#define TRANSFORM_CACHE_SYSFS 1
+#else
+#define TRANSFORM_CACHE_SYSFS 0
+#endif
+#endif /* TRANSFORM_CACHE_SYSFS */
+
+#ifndef TRANSFORM_CACHE_L1D
+#define TRANSFORM_CACHE_L1D (32 * 1024)
+#endif
+#ifndef TRANSFORM_CACHE_L2
+#define TRANSFORM_CACHE_L2 (256 * 1024)
+#endif
+#ifndef TRANSFORM_CACHE_L3
+#define TRANSFORM_CACHE_L3 0
+#endif
+#ifndef TRANSFORM_CACHE_LINE
+#define TRANSFORM_CACHE_LINE 64
+#endif
+
+#if TRANSFORM_CACHE_SYSFS
+#include <cstdio>
+#include <cstring>
+#endif /* TRANSFORM_CACHE_SYSFS */
+
+struct CacheInfo {
+    reg l1d = TRANSFORM_CACHE_L1D;
+    reg l2 = TRANSFORM_CACHE_L2;
+    reg l3 = TRANSFORM_CACHE_L3;        // 0 if not present or unknown
+    reg line = TRANSFORM_CACHE_LINE;
+    bool detected = false;              // true when read from sysfs
+};
+
+namespace cache_detail {
+
+#if TRANSFORM_CACHE_SYSFS
+// First line of a small sysfs file, false if it cannot be read
+inline bool readLine(const char* path, char* buffer, int size) {
+    std::FILE* file = std::fopen(path, "r");
+    if (file == nullptr) {
+        return false;
+    }
+    const bool ok = std::fgets(buffer, size, file) != nullptr;
+    std::fclose(file);
+    return ok;
+}
+
+// "48K", "2048K", "30M" -> bytes
+inline reg parseSize(const char* text) {
+    reg value = 0;
+    while (*text >= '0' && *text <= '9') {
+        value = value * 10 + static_cast<reg>(*text - '0');
+        ++text;
+    }
+    if (*text == 'K') value *= 1024;
+    else if (*text == 'M') value *= 1024 * 1024;
+    return value;
+}
+#endif /* TRANSFORM_CACHE_SYSFS */
+
+inline CacheInfo detect() {
+    CacheInfo info;
+
+#if TRANSFORM_CACHE_SYSFS
+    char path[96];
+    char text[64];
+    for (int index = 0; index < 16; ++index) {
+        std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/type", index);
+        if (!readLine(path, text, sizeof(text))) {
+            break;
+        }
+        if (std::strncmp(text, "Instruction", 11) == 0) {
+            continue;
+        }
+
+        std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/level", index);
+        if (!readLine(path, text, sizeof(text))) {
+            continue;
+        }
+        const int level = text[0] - '0';
+
+        std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/size", index);
+        if (!readLine(path, text, sizeof(text))) {
+            continue;
+        }
+        const reg size = parseSize(text);
+        if (size == 0) {
+            continue;
+        }
+
+        if (level == 1) info.l1d = size;
+        else if (level == 2) info.l2 = size;
+        else if (level == 3) info.l3 = size;
+        info.detected = true;
+
+        std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/coherency_line_size", index);
+        if (level == 1 && readLine(path, text, sizeof(text)) && parseSize(text) > 0) {
+            info.line = parseSize(text);
+        }
+    }
+#endif /* TRANSFORM_CACHE_SYSFS */
+
+    return info;
+}
+
+} // namespace cache_detail
+
+// Detected once, on first use
+inline const CacheInfo& cacheInfo() {
+    static const CacheInfo info = cache_detail::detect();
+    return info;
+}
+
+// Bytes per cache-blocked tile: half of L2, the other half is left for stage
+// state, tables and the next tile's prefetch
+inline reg defaultTileBytes() {
+    const reg bytes = cacheInfo().l2 / 2;
+    return bytes < 16 * 1024 ? 16 * 1024 : bytes;
+}
+
+#endif /* ___MATH_TRANSFORM_CACHE_INFO_H_ */
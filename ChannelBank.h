@@ -0,0 +1,252 @@
+/*
+ * ChannelBank.h
+ *
+ * ChannelBank runs the same stage pipeline over many channels at once.
+ * Every channel has its own copy of the stage parameters (Multiply factor,
+ * Add increment, ...) and its own flags, but the data is stored frame-major
+ * (all channels of sample 0, then all channels of sample 1, ...), so the
+ * innermost loop walks channels and their parameters side by side and can be
+ * vectorized across channels.
+ *
+ * Stage parameters are kept in structure-of-arrays form: a BankLane holds one
+ * array per stage type (for single-parameter stages such as Multiply/Add that
+ * is exactly an array of coefficients). Stateless stages are stored once.
+ *
+ * Note: the whole bank (Channels * N results) is stored inline, as in
+ * Transform, so large banks should be allocated on the heap.
+ */
+
+#ifndef ___MATH_TRANSFORM_CHANNEL_BANK_H_
+#define ___MATH_TRANSFORM_CHANNEL_BANK_H_
+
+#include "Transform.h"
+
+// Per-channel storage of one stage type
+template<typename Stage, reg Channels, bool Shared = std::is_empty_v<Stage>>
+class BankLane {
+public:
+    BankLane() = default;
+    explicit BankLane(const Stage& stage) { m_lanes.fill(stage); }
+
+    inline constexpr Stage& at(reg channel) { return m_lanes[channel]; }
+    inline constexpr const Stage& at(reg channel) const { return m_lanes[channel]; }
+
+private:
+    std::array<Stage, Channels> m_lanes = {};
+};
+
+// Stateless stages are shared by every channel
+template<typename Stage, reg Channels>
+class BankLane<Stage, Channels, true> {
+public:
+    BankLane() = default;
+    explicit BankLane(const Stage& stage) : m_stage(stage) {}
+
+    inline constexpr Stage& at(reg) { return m_stage; }
+    inline constexpr const Stage& at(reg) const { return m_stage; }
+
+private:
+    Stage m_stage = {};
+};
+
+// Main ChannelBank class
+template<reg Channels, reg N, typename ResultType, bool UseFlags = true, typename... Transforms>
+class ChannelBank {
+    static_assert(Channels > 0, "Channels must be more than 0.");
+
+    // Same stage list as a single-channel Transform: reuse its flags and Break rules
+    using Shape = Transform<N, ResultType, UseFlags, Transforms...>;
+    using Plan = StagePlan<Transforms...>;
+
+public:
+    using FlagsType = typename Shape::FlagsType;
+    using Frame = std::array<ResultType, Channels>;  // one sample of every channel
+    using Data = std::array<Frame, N>;
+
+    ChannelBank() : m_lanes() { setFlags(FlagsType()); }
+
+    // Every channel starts with the same stage parameters
+    explicit ChannelBank(const Transforms&... transforms) : m_lanes(BankLane<Transforms, Channels>(transforms)...) {
+        setFlags(FlagsType());
+    }
+
+    // Stage Index of one channel
+    template<std::size_t Index>
+    inline constexpr auto& get(reg channel) {
+        static_assert(Index < sizeof...(Transforms), "Index out of bounds.");
+        return std::get<Index>(m_lanes).at(channel);
+    }
+
+    // Same flags for every channel
+    inline void setFlags(const FlagsType& flags) {
+        if constexpr (UseFlags) {
+            m_flags.fill(flags);
+            updateMasks();
+            resetPostBreakFlag();
+        }
+    }
+
+    inline void setFlags(reg channel, const FlagsType& flags) {
+        if constexpr (UseFlags) {
+            if (channel >= Channels) {
+                return;
+            }
+            m_flags[channel] = flags;
+            updateMasks();
+            resetPostBreakFlag();
+        }
+    }
+
+    inline bool ena(reg channel, std::size_t index) {
+        if constexpr (UseFlags) {
+            if (channel >= Channels || index >= sizeof...(Transforms)) {
+                return false;
+            }
+            m_flags[channel].set(index);
+            updateMasks();
+            resetPostBreakFlag();
+        }
+        return true;
+    }
+
+    // Input is interleaved: N frames of Channels values each
+    template<typename Input>
+    bool process(const Input& input) {
+        resetPostBreakFlag();
+
+        if constexpr (std::is_same_v<Input, Data>) {
+            m_results = input;
+        } else if constexpr (std::is_array_v<Input>) {
+            if constexpr (std::extent_v<Input> < N * Channels) { // Checking the array size
+                return false; // Array too small
+            }
+            loadInterleaved(std::data(input));
+        } else if constexpr (is_std_vector_v<Input> || is_std_array_v<Input> ||
+                             std::is_same_v<Input, Span<typename Input::value_type>>) {
+            if (input.size() < N * Channels) {
+                return false;
+            }
+            loadInterleaved(input.data());
+        } else {
+            return false;
+        }
+
+        if constexpr (UseFlags) {
+            if (m_anyMask.none()) return true;
+        }
+
+        Plan::forEachBeforeBreak([this](auto index) { applyTransform<decltype(index)::value>(); });
+        return true;
+    }
+
+    inline Data& results() {
+        if constexpr (Plan::HasAfterBreak) {
+            if (!m_postBreakComputed) {
+                Plan::forEachAfterBreak([this](auto index) { applyTransform<decltype(index)::value>(); });
+                m_postBreakComputed = true;
+            }
+        }
+        return m_results;
+    }
+
+    inline constexpr Data& get_array() {
+        return m_results;
+    }
+
+    // Value of one channel at sample index (no post-Break evaluation)
+    inline constexpr ResultType value(reg channel, reg index) const {
+        return m_results[index][channel];
+    }
+
+private:
+    template<typename T>
+    inline void loadInterleaved(const T* src) {
+        if constexpr (std::is_same_v<std::remove_cv_t<T>, ResultType>) {
+            std::memcpy(m_results.data(), src, N * Channels * sizeof(ResultType));
+        } else {
+            for (reg i = 0; i < N; ++i) {
+                for (reg c = 0; c < Channels; ++c) {
+                    m_results[i][c] = static_cast<ResultType>(src[i * Channels + c]);
+                }
+            }
+        }
+    }
+
+    template<std::size_t Index>
+    inline void applyTransform() {
+        using TransformType = std::tuple_element_t<Index, std::tuple<Transforms...>>;
+
+        if constexpr (std::is_same_v<TransformType, Break>) {
+            return;
+        } else {
+            auto& lane = std::get<Index>(m_lanes);
+
+            if constexpr (UseFlags) {
+                if (!m_anyMask.template test<Index>()) {
+                    return; // disabled on every channel
+                }
+
+                if (!m_allMask.template test<Index>()) {
+                    // Mixed: compute every channel and blend, keeps the loop branch-free
+                    const auto& enabled = m_enabled[Index];
+                    for (auto& frame : m_results) {
+                        for (reg c = 0; c < Channels; ++c) {
+                            const ResultType value = static_cast<ResultType>(lane.at(c).apply(frame[c]));
+                            frame[c] = enabled[c] ? value : frame[c];
+                        }
+                    }
+                    return;
+                }
+            }
+
+            for (auto& frame : m_results) {
+                for (reg c = 0; c < Channels; ++c) {
+                    frame[c] = static_cast<ResultType>(lane.at(c).apply(frame[c]));
+                }
+            }
+        }
+    }
+
+    inline void updateMasks() {
+        FlagsType any(0);
+        FlagsType all;
+        for (const FlagsType& flags : m_flags) {
+            any |= flags;
+            all &= flags;
+        }
+        m_anyMask = any;
+        m_allMask = all;
+
+        for (reg index = 0; index < sizeof...(Transforms); ++index) {
+            for (reg c = 0; c < Channels; ++c) {
+                m_enabled[index][c] = m_flags[c].test(index);
+            }
+        }
+    }
+
+    inline constexpr void resetPostBreakFlag() {
+        if constexpr (Plan::HasAfterBreak) {
+            m_postBreakComputed = false;
+        }
+    }
+
+public:
+    static constexpr std::size_t ChannelCount = Channels;
+    static constexpr std::size_t TransformSize = Shape::TransformSize;
+    static constexpr std::size_t DataSize = N;
+    static constexpr std::size_t BreakIndex = Shape::BreakIndex;
+    static constexpr bool BreakExists = Shape::BreakExists;
+    static constexpr std::size_t BeforeBreakCount = Shape::BeforeBreakCount;
+    static constexpr std::size_t AfterBreakCount = Shape::AfterBreakCount;
+
+private:
+    Data m_results = {};
+    std::tuple<BankLane<Transforms, Channels>...> m_lanes;
+    std::array<FlagsType, Channels> m_flags = {};
+    std::array<std::array<bool, Channels>, sizeof...(Transforms)> m_enabled = {};
+    FlagsType m_anyMask = {};
+    FlagsType m_allMask = {};
+    bool m_postBreakComputed = false;
+};
+
+#endif /* ___MATH_TRANSFORM_CHANNEL_BANK_H_ */
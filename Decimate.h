@@ -0,0 +1,158 @@
+/*
+ * Decimate.h
+ *
+ * Display decimation of large result arrays.
+ *
+ * MinMaxDecimate is a pass-through stage: put it last in a Transform and the
+ * final pass over the data also collects a min/max envelope of Width buckets
+ * (one per screen pixel column), so plotting needs Width * 2 points instead
+ * of N. It is an indexed stage: the bucket comes from the element index, so
+ * the frame may be computed in parts and in any order (results(offset, count),
+ * Tiled). decimateMinMax() does the same for an arbitrary buffer, and lttb()
+ * picks representative points with Largest-Triangle-Three-Buckets.
+ */
+
+#ifndef ___MATH_TRANSFORM_DECIMATE_H_
+#define ___MATH_TRANSFORM_DECIMATE_H_
+
+#include "basic_types.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+template<typename T>
+struct Envelope {
+    T min;
+    T max;
+};
+
+// Envelope of bucket b covers samples [b * count / width, (b + 1) * count / width)
+template<typename T>
+inline void decimateMinMax(const T* data, reg count, Envelope<T>* out, reg width) {
+    if (width == 0 || count == 0) {
+        return;
+    }
+
+    for (reg bucket = 0; bucket < width; ++bucket) {
+        const reg begin = bucket * count / width;
+        reg end = (bucket + 1) * count / width;
+        if (end == begin) {
+            end = begin + 1; // more buckets than samples: repeat the sample
+        }
+
+        T lo = data[begin];
+        T hi = data[begin];
+        for (reg i = begin + 1; i < end; ++i) {
+            lo = std::min(lo, data[i]);
+            hi = std::max(hi, data[i]);
+        }
+        out[bucket] = Envelope<T>{lo, hi};
+    }
+}
+
+// Pass-through stage collecting a Width-bucket envelope of every N-sample frame,
+// buckets as in decimateMinMax(). The envelope is cleared when a frame starts;
+// buckets whose samples were not computed yet hold {max(), lowest()}.
+template<reg N, reg Width, typename T = float>
+class MinMaxDecimate {
+    static_assert(Width > 0 && Width <= N, "Width must be in range [1, N].");
+
+public:
+    MinMaxDecimate() = default;
+
+    inline constexpr void beginFrame() {
+        for (Envelope<T>& bucket : m_envelope) {
+            bucket = Envelope<T>{std::numeric_limits<T>::max(), std::numeric_limits<T>::lowest()};
+        }
+    }
+
+    // index < N: position of value in the frame
+    inline constexpr T apply(T value, reg index) {
+        Envelope<T>& bucket = m_envelope[bucketOf(index)];
+        bucket.min = std::min(bucket.min, value);
+        bucket.max = std::max(bucket.max, value);
+        return value;
+    }
+
+    inline constexpr const std::array<Envelope<T>, Width>& envelope() const {
+        return m_envelope;
+    }
+
+    // Last bucket b with b * N / Width <= index (N is a constant, the division compiles to a multiply)
+    static constexpr reg bucketOf(reg index) {
+        return ((index + 1) * Width - 1) / N;
+    }
+
+private:
+    std::array<Envelope<T>, Width> m_envelope = {};
+};
+
+template<typename T>
+struct LttbPoint {
+    reg index;
+    T value;
+};
+
+// Largest-Triangle-Three-Buckets downsampling to `threshold` points
+template<typename T>
+inline std::vector<LttbPoint<T>> lttb(const T* data, reg count, reg threshold) {
+    std::vector<LttbPoint<T>> points;
+    if (threshold >= count || threshold < 3) {
+        points.reserve(count);
+        for (reg i = 0; i < count; ++i) {
+            points.push_back(LttbPoint<T>{i, data[i]});
+        }
+        return points;
+    }
+
+    points.reserve(threshold);
+    points.push_back(LttbPoint<T>{0, data[0]});
+
+    const f64 every = static_cast<f64>(count - 2) / static_cast<f64>(threshold - 2);
+    reg a = 0;
+
+    for (reg bucket = 0; bucket < threshold - 2; ++bucket) {
+        // Average of the next bucket
+        reg avgBegin = static_cast<reg>(std::floor((bucket + 1) * every)) + 1;
+        reg avgEnd = std::min(static_cast<reg>(std::floor((bucket + 2) * every)) + 1, count);
+        if (avgBegin >= avgEnd) {
+            avgBegin = avgEnd - 1;
+        }
+
+        f64 avgX = 0.0;
+        f64 avgY = 0.0;
+        for (reg i = avgBegin; i < avgEnd; ++i) {
+            avgX += static_cast<f64>(i);
+            avgY += static_cast<f64>(data[i]);
+        }
+        avgX /= static_cast<f64>(avgEnd - avgBegin);
+        avgY /= static_cast<f64>(avgEnd - avgBegin);
+
+        // Point of the current bucket forming the largest triangle
+        const reg begin = static_cast<reg>(std::floor(bucket * every)) + 1;
+        const reg end = static_cast<reg>(std::floor((bucket + 1) * every)) + 1;
+        const f64 ax = static_cast<f64>(a);
+        const f64 ay = static_cast<f64>(data[a]);
+
+        f64 maxArea = -1.0;
+        reg chosen = begin;
+        for (reg i = begin; i < end; ++i) {
+            const f64 area = std::fabs((ax - avgX) * (static_cast<f64>(data[i]) - ay) -
+                                       (ax - static_cast<f64>(i)) * (avgY - ay));
+            if (area > maxArea) {
+                maxArea = area;
+                chosen = i;
+            }
+        }
+
+        points.push_back(LttbPoint<T>{chosen, data[chosen]});
+        a = chosen;
+    }
+
+    points.push_back(LttbPoint<T>{count - 1, data[count - 1]});
+    return points;
+}
+
+#endif /* ___MATH_TRANSFORM_DECIMATE_H_ */
@@ -0,0 +1,171 @@
+/*
+ * DeltaTransform.h
+ *
+ * Delta processing for slowly changing inputs (register snapshots and the
+ * like): only the elements whose input value changed since the previous
+ * process() call are recomputed.
+ *
+ * The new input is compared with the previous one block by block (a
+ * vectorizable OR-reduction skips unchanged blocks), the changed elements are
+ * compacted into a dense buffer, run through all stages at once (pre-Break,
+ * then post-Break) and scattered back into the cached intermediate and final
+ * results. When more than denseFraction() of the elements changed, or the
+ * cache is not valid (first frame, flags or stages changed), a normal dense
+ * pass is used instead.
+ *
+ * Stages must be pure element-wise functions: a stage that keeps state
+ * between calls (e.g. MinMaxDecimate) would only see the changed elements.
+ * Elements compare with !=, so a NaN input is recomputed on every call.
+ */
+
+#ifndef ___MATH_TRANSFORM_DELTA_TRANSFORM_H_
+#define ___MATH_TRANSFORM_DELTA_TRANSFORM_H_
+
+#include "Transform.h"
+
+template<reg N, typename ResultType, bool UseFlags = true, typename... Transforms>
+class DeltaTransform {
+    static_assert(N <= 0xFFFFFFFFU, "N must fit the u32 change index.");
+
+public:
+    using Engine = Transform<N, ResultType, UseFlags, Transforms...>;
+    using FlagsType = typename Engine::FlagsType;
+
+    static_assert(!Engine::HasBlockStages, "Block stages need the whole buffer and cannot run on partial ranges.");
+    static_assert(!Engine::HasIndexedStages, "Indexed stages need frame positions, partial ranges have none.");
+
+    static constexpr reg BlockSize = 64;
+
+    DeltaTransform() = default;
+
+    explicit DeltaTransform(Transforms... transforms) : m_engine(transforms...) {}
+
+    // Stage access invalidates the cache: the next call runs dense
+    template<std::size_t Index>
+    inline constexpr auto& get() {
+        invalidate();
+        return m_engine.template get<Index>();
+    }
+
+    inline constexpr void setFlags(const FlagsType& flags) {
+        m_engine.setFlags(flags);
+        invalidate();
+    }
+
+    inline constexpr void invalidate() {
+        m_valid = false;
+    }
+
+    // Fraction of changed elements above which a dense pass is used
+    inline constexpr void setDenseFraction(f32 fraction) {
+        m_denseLimit = static_cast<reg>(fraction * static_cast<f32>(N));
+    }
+
+    inline constexpr f32 denseFraction() const {
+        return static_cast<f32>(m_denseLimit) / static_cast<f32>(N);
+    }
+
+    template<typename Input>
+    bool process(const Input& input) {
+        std::array<ResultType, N>& current = m_inputs[m_current];
+        if (!Engine::loadInput(input, current)) {
+            return false;
+        }
+
+        const reg changed = m_valid ? collectChanges(current, m_inputs[m_current ^ 1]) : N;
+
+        if (!m_valid || changed > m_denseLimit) {
+            processDense(current);
+            m_lastChanged = N;
+        } else {
+            processSparse(current, changed);
+            m_lastChanged = changed;
+        }
+
+        m_current ^= 1;
+        m_valid = true;
+        return true;
+    }
+
+    // Final results (post-Break stages included)
+    inline constexpr std::array<ResultType, N>& results() {
+        return m_final;
+    }
+
+    // Results before Break
+    inline constexpr std::array<ResultType, N>& get_array() {
+        return m_intermediate;
+    }
+
+    // Elements recomputed by the last call (N for a dense pass)
+    inline constexpr reg lastChanged() const {
+        return m_lastChanged;
+    }
+
+private:
+    // Fills m_index with the changed element indices, returns their count
+    inline reg collectChanges(const std::array<ResultType, N>& current, const std::array<ResultType, N>& previous) {
+        reg changed = 0;
+
+        for (reg begin = 0; begin < N; begin += BlockSize) {
+            const reg end = (begin + BlockSize < N) ? begin + BlockSize : N;
+
+            bool any = false;
+            for (reg i = begin; i < end; ++i) {
+                any |= (current[i] != previous[i]);
+            }
+            if (!any) {
+                continue;
+            }
+
+            // Branch-free compaction of the block
+            for (reg i = begin; i < end; ++i) {
+                m_index[changed] = static_cast<u32>(i);
+                changed += (current[i] != previous[i]) ? 1 : 0;
+            }
+
+            if (changed > m_denseLimit) {
+                return changed; // dense pass anyway, stop scanning
+            }
+        }
+        return changed;
+    }
+
+    inline void processDense(const std::array<ResultType, N>& current) {
+        m_intermediate = current;
+        m_engine.applyBeforeBreak(m_intermediate.data(), N);
+        m_final = m_intermediate;
+        m_engine.applyAfterBreak(m_final.data(), N);
+    }
+
+    inline void processSparse(const std::array<ResultType, N>& current, reg changed) {
+        for (reg k = 0; k < changed; ++k) {
+            m_compact[k] = current[m_index[k]];
+        }
+
+        // Fused through the Break: one compact pass for both halves
+        m_engine.applyBeforeBreak(m_compact.data(), changed);
+        for (reg k = 0; k < changed; ++k) {
+            m_intermediate[m_index[k]] = m_compact[k];
+        }
+
+        m_engine.applyAfterBreak(m_compact.data(), changed);
+        for (reg k = 0; k < changed; ++k) {
+            m_final[m_index[k]] = m_compact[k];
+        }
+    }
+
+private:
+    Engine m_engine;
+    std::array<std::array<ResultType, N>, 2> m_inputs = {};
+    std::array<ResultType, N> m_intermediate = {};
+    std::array<ResultType, N> m_final = {};
+    std::array<ResultType, N> m_compact = {};
+    std::array<u32, N> m_index = {};
+    reg m_current = 0;
+    reg m_lastChanged = N;
+    reg m_denseLimit = N / 4;
+    bool m_valid = false;
+};
+
+#endif /* ___MATH_TRANSFORM_DELTA_TRANSFORM_H_ */
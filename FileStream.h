@@ -0,0 +1,361 @@
+/*
+ * FileStream.h
+ *
+ * FileStream runs a Transform over a raw binary capture file and writes the
+ * results to another raw file, frame by frame (N elements per frame).
+ *
+ * On POSIX systems both files are memory-mapped: input elements are
+ * converted straight into the output mapping and the stages run there in
+ * place (Transform::apply()), so a frame is never copied into the Transform
+ * and back out. Pipelines of plain element stages (FrameIndependent) run over
+ * cache-sized pieces of many frames at once, the others frame by frame. The
+ * input is processed in large chunks and the kernel is asked to read the next
+ * chunk ahead (madvise WILLNEED) while the current one is being computed, and
+ * to drop chunks that are done. The output file is allocated up front
+ * (posix_fallocate), so a full disk is an error instead of a SIGBUS on a
+ * page of the mapping; if it cannot be allocated the buffered path is used.
+ *
+ * When mapping is not possible (or disabled, or on other platforms) the
+ * stream falls back to chunked pread/pwrite (fread/fwrite elsewhere) with
+ * double buffering: the next chunk is read on a helper thread while the
+ * current chunk is processed.
+ *
+ * A trailing partial frame (file size not a multiple of N elements) is not
+ * processed and is reported in StreamStats::tailElements.
+ */
+
+#ifndef ___MATH_TRANSFORM_FILE_STREAM_H_
+#define ___MATH_TRANSFORM_FILE_STREAM_H_
+
+#include "Transform.h"
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TRANSFORM_FILE_STREAM_POSIX 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define TRANSFORM_FILE_STREAM_POSIX 0
+#endif /* defined(__unix__) || defined(__APPLE__) */
+
+struct StreamStats {
+    u64 frames = 0;
+    u64 bytesIn = 0;
+    u64 bytesOut = 0;
+    u64 tailElements = 0;   // input elements after the last full frame
+    f64 seconds = 0.0;
+    bool mapped = false;    // true if the memory-mapped path was used
+
+    inline f64 inputGBps() const { return seconds > 0.0 ? static_cast<f64>(bytesIn) / seconds / 1e9 : 0.0; }
+    inline f64 totalGBps() const { return seconds > 0.0 ? static_cast<f64>(bytesIn + bytesOut) / seconds / 1e9 : 0.0; }
+};
+
+// InputType is the element type stored in the input file
+template<typename InputType, typename TransformType>
+class FileStream {
+    using ResultArray = std::remove_reference_t<decltype(std::declval<TransformType&>().results())>;
+    using ResultType = typename ResultArray::value_type;
+    static constexpr reg N = TransformType::DataSize;
+
+    static_assert(std::is_arithmetic_v<InputType>, "InputType must be an arithmetic type.");
+
+public:
+    static constexpr reg DefaultChunkBytes = 8U << 20;
+
+    explicit FileStream(TransformType& transform, reg chunkBytes = DefaultChunkBytes)
+        : m_transform(transform), m_chunkFrames(chunkBytes / (N * sizeof(InputType))) {
+        if (m_chunkFrames == 0) {
+            m_chunkFrames = 1;
+        }
+    }
+
+    // Disables the memory-mapped path (e.g. for files on network shares)
+    inline void setUseMmap(bool use) { m_useMmap = use; }
+
+    inline reg chunkFrames() const { return m_chunkFrames; }
+
+    bool run(const std::string& inputPath, const std::string& outputPath, StreamStats& stats) {
+        stats = StreamStats{};
+        const auto start = std::chrono::steady_clock::now();
+
+        bool ok = false;
+#if TRANSFORM_FILE_STREAM_POSIX
+        if (m_useMmap) {
+            ok = runMapped(inputPath, outputPath, stats);
+        }
+#endif /* TRANSFORM_FILE_STREAM_POSIX */
+        if (!stats.mapped) {
+            ok = runBuffered(inputPath, outputPath, stats);
+        }
+
+        stats.seconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+        return ok;
+    }
+
+private:
+    // Elements converted and computed at a time: one frame, or ~64 KiB (still in
+    // L2) of whole frames when the stages ignore frame boundaries
+    static constexpr reg PieceElements = TransformType::FrameIndependent && N * sizeof(ResultType) < (64U << 10)
+                                         ? (64U << 10) / sizeof(ResultType) / N * N : N;
+
+    // frames frames: input elements -> output elements, then the stages in place
+    inline void processFrames(const InputType* in, ResultType* out, reg frames) {
+        const reg count = frames * N;
+        for (reg begin = 0; begin < count; begin += PieceElements) {
+            const reg size = (count - begin < PieceElements) ? count - begin : PieceElements;
+            if constexpr (std::is_same_v<InputType, ResultType>) {
+                std::memcpy(out + begin, in + begin, size * sizeof(ResultType));
+            } else {
+                for (reg i = 0; i < size; ++i) {
+                    out[begin + i] = static_cast<ResultType>(in[begin + i]);
+                }
+            }
+            m_transform.apply(out + begin, size);
+        }
+    }
+
+#if TRANSFORM_FILE_STREAM_POSIX
+    bool runMapped(const std::string& inputPath, const std::string& outputPath, StreamStats& stats) {
+        const int in = ::open(inputPath.c_str(), O_RDONLY);
+        if (in < 0) {
+            return false;
+        }
+
+        struct stat st = {};
+        if (::fstat(in, &st) != 0) {
+            ::close(in);
+            return false;
+        }
+
+        const u64 elements = static_cast<u64>(st.st_size) / sizeof(InputType);
+        const u64 frames = elements / N;
+        const u64 inBytes = frames * N * sizeof(InputType);
+        const u64 outBytes = frames * N * sizeof(ResultType);
+
+        const int out = ::open(outputPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (out < 0) {
+            ::close(in);
+            return false;
+        }
+
+        if (frames == 0) {
+            // Nothing to map, an empty output is the whole result
+            ::close(in);
+            ::close(out);
+            stats.mapped = true;
+            stats.tailElements = elements;
+            return true;
+        }
+
+        if (!allocate(out, outBytes)) {
+            ::close(in);
+            ::close(out);
+            return false; // caller falls back to buffered I/O, which reports a full disk
+        }
+
+        void* inMap = ::mmap(nullptr, inBytes, PROT_READ, MAP_SHARED, in, 0);
+        void* outMap = ::mmap(nullptr, outBytes, PROT_READ | PROT_WRITE, MAP_SHARED, out, 0);
+        ::close(in);
+        ::close(out);
+
+        if (inMap == MAP_FAILED || outMap == MAP_FAILED) {
+            if (inMap != MAP_FAILED) ::munmap(inMap, inBytes);
+            if (outMap != MAP_FAILED) ::munmap(outMap, outBytes);
+            return false; // caller falls back to buffered I/O
+        }
+
+        stats.mapped = true;
+        ::madvise(inMap, inBytes, MADV_SEQUENTIAL);
+
+        const InputType* src = static_cast<const InputType*>(inMap);
+        ResultType* dst = static_cast<ResultType*>(outMap);
+        const reg chunkElements = m_chunkFrames * N;
+
+        for (u64 frame = 0; frame < frames; frame += m_chunkFrames) {
+            const u64 count = (frames - frame) < m_chunkFrames ? (frames - frame) : m_chunkFrames;
+            const u64 first = frame * N;
+
+            // Read the next chunk ahead while this one is computed
+            if (frame + m_chunkFrames < frames) {
+                adviseRange(inMap, inBytes, (first + chunkElements) * sizeof(InputType),
+                            chunkElements * sizeof(InputType), MADV_WILLNEED);
+            }
+
+            processFrames(src + first, dst + first, static_cast<reg>(count));
+
+            // Done with this part of the input
+            adviseRange(inMap, inBytes, first * sizeof(InputType), count * N * sizeof(InputType), MADV_DONTNEED);
+        }
+
+        ::munmap(inMap, inBytes);
+        ::munmap(outMap, outBytes);
+
+        stats.frames = frames;
+        stats.bytesIn = inBytes;
+        stats.bytesOut = outBytes;
+        stats.tailElements = elements - frames * N;
+        return true;
+    }
+
+    // Reserves the blocks of the whole file, so writes through the mapping cannot fail
+    static inline bool allocate(int fd, u64 bytes) {
+#if defined(__APPLE__)
+        fstore_t store = {F_ALLOCATEALL, F_PEOFPOSMODE, 0, static_cast<off_t>(bytes), 0};
+        return ::fcntl(fd, F_PREALLOCATE, &store) != -1 && ::ftruncate(fd, static_cast<off_t>(bytes)) == 0;
+#else
+        return ::posix_fallocate(fd, 0, static_cast<off_t>(bytes)) == 0;
+#endif /* defined(__APPLE__) */
+    }
+
+    // madvise on the whole pages inside [offset, offset + length)
+    static inline void adviseRange(void* base, u64 size, u64 offset, u64 length, int advice) {
+        static const u64 page = static_cast<u64>(::sysconf(_SC_PAGESIZE));
+        u64 begin = (offset + page - 1) / page * page;
+        u64 end = offset + length;
+        if (end > size) {
+            end = size;
+        }
+        end = end / page * page;
+        if (advice == MADV_WILLNEED) {
+            begin = offset / page * page; // reading ahead a partial page is harmless
+        }
+        if (begin < end) {
+            ::madvise(static_cast<u8*>(base) + begin, end - begin, advice);
+        }
+    }
+#endif /* TRANSFORM_FILE_STREAM_POSIX */
+
+    // Sequential reader/writer: pread/pwrite on POSIX, stdio elsewhere
+    class RawFile {
+    public:
+        RawFile(const std::string& path, bool write) {
+#if TRANSFORM_FILE_STREAM_POSIX
+            m_fd = write ? ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644) : ::open(path.c_str(), O_RDONLY);
+#else
+            m_file = std::fopen(path.c_str(), write ? "wb" : "rb");
+#endif /* TRANSFORM_FILE_STREAM_POSIX */
+        }
+
+        ~RawFile() {
+#if TRANSFORM_FILE_STREAM_POSIX
+            if (m_fd >= 0) ::close(m_fd);
+#else
+            if (m_file) std::fclose(m_file);
+#endif /* TRANSFORM_FILE_STREAM_POSIX */
+        }
+
+        RawFile(const RawFile&) = delete;
+        RawFile& operator=(const RawFile&) = delete;
+
+        inline bool isOpen() const {
+#if TRANSFORM_FILE_STREAM_POSIX
+            return m_fd >= 0;
+#else
+            return m_file != nullptr;
+#endif /* TRANSFORM_FILE_STREAM_POSIX */
+        }
+
+        // Reads up to size bytes, returns the number of bytes read
+        reg read(void* data, reg size) {
+            reg done = 0;
+#if TRANSFORM_FILE_STREAM_POSIX
+            while (done < size) {
+                const ssize_t n = ::pread(m_fd, static_cast<u8*>(data) + done, size - done, static_cast<off_t>(m_offset));
+                if (n <= 0) break;
+                done += static_cast<reg>(n);
+                m_offset += static_cast<u64>(n);
+            }
+#else
+            done = std::fread(data, 1, size, m_file);
+#endif /* TRANSFORM_FILE_STREAM_POSIX */
+            return done;
+        }
+
+        bool write(const void* data, reg size) {
+#if TRANSFORM_FILE_STREAM_POSIX
+            reg done = 0;
+            while (done < size) {
+                const ssize_t n = ::pwrite(m_fd, static_cast<const u8*>(data) + done, size - done, static_cast<off_t>(m_offset));
+                if (n <= 0) return false;
+                done += static_cast<reg>(n);
+                m_offset += static_cast<u64>(n);
+            }
+            return true;
+#else
+            return std::fwrite(data, 1, size, m_file) == size;
+#endif /* TRANSFORM_FILE_STREAM_POSIX */
+        }
+
+    private:
+#if TRANSFORM_FILE_STREAM_POSIX
+        int m_fd = -1;
+        u64 m_offset = 0;
+#else
+        std::FILE* m_file = nullptr;
+#endif /* TRANSFORM_FILE_STREAM_POSIX */
+    };
+
+    bool runBuffered(const std::string& inputPath, const std::string& outputPath, StreamStats& stats) {
+        RawFile in(inputPath, false);
+        if (!in.isOpen()) {
+            return false;
+        }
+        RawFile out(outputPath, true);
+        if (!out.isOpen()) {
+            return false;
+        }
+
+        const reg chunkElements = m_chunkFrames * N;
+        std::vector<InputType> buffers[2] = {std::vector<InputType>(chunkElements), std::vector<InputType>(chunkElements)};
+        std::vector<ResultType> results(chunkElements);
+
+        auto readChunk = [&in, chunkElements](std::vector<InputType>* buffer) {
+            return in.read(buffer->data(), chunkElements * sizeof(InputType)) / sizeof(InputType);
+        };
+
+        reg current = 0;
+        reg available = readChunk(&buffers[current]);
+        bool ok = true;
+
+        while (available > 0) {
+            // Prefetch the next chunk while this one is computed
+            std::future<reg> next;
+            if (available == chunkElements) {
+                next = std::async(std::launch::async, readChunk, &buffers[current ^ 1]);
+            }
+
+            const reg frames = available / N;
+            processFrames(buffers[current].data(), results.data(), frames);
+
+            if (!out.write(results.data(), frames * N * sizeof(ResultType))) {
+                ok = false;
+            }
+
+            stats.frames += frames;
+            stats.bytesIn += frames * N * sizeof(InputType);
+            stats.bytesOut += frames * N * sizeof(ResultType);
+            stats.tailElements = available - frames * N;
+
+            available = next.valid() ? next.get() : 0;
+            current ^= 1;
+
+            if (!ok) {
+                break;
+            }
+        }
+
+        return ok;
+    }
+
+private:
+    TransformType& m_transform;
+    reg m_chunkFrames = 1;
+    bool m_useMmap = true;
+};
+
+#endif /* ___MATH_TRANSFORM_FILE_STREAM_H_ */
@@ -0,0 +1,104 @@
+/*
+ * FlagMask.h
+ *
+ * Stage enable flags sized by the stage count.
+ *
+ * Up to 32 stages the mask is a single u32 (exactly what Transform used
+ * before), up to 64 a single u64, above that an array of u64 words. Checks
+ * with a compile-time index (test<Index>()) pick the word and the bit at
+ * compile time, so they stay a single load + test whatever the width.
+ *
+ * Integer values assign the low bits; the default mask has every bit set.
+ */
+
+#ifndef ___MATH_TRANSFORM_FLAG_MASK_H_
+#define ___MATH_TRANSFORM_FLAG_MASK_H_
+
+#include "basic_types.h"
+#include <array>
+#include <type_traits>
+
+template<std::size_t Bits>
+class FlagMask {
+public:
+    using Word = std::conditional_t<(Bits <= 32), u32, u64>;
+
+    static constexpr std::size_t WordBits = sizeof(Word) * 8;
+    static constexpr std::size_t WordCount = (Bits == 0) ? 1 : (Bits + WordBits - 1) / WordBits;
+
+    // All flags set
+    constexpr FlagMask() {
+        for (auto& word : m_words) {
+            word = ~Word(0);
+        }
+    }
+
+    // Low bits from an integer, the rest cleared
+    constexpr FlagMask(u64 value) {
+        m_words[0] = static_cast<Word>(value);
+        if constexpr (WordCount > 1) {
+            for (std::size_t i = 1; i < WordCount; ++i) {
+                m_words[i] = 0;
+            }
+        }
+    }
+
+    template<std::size_t Index>
+    inline constexpr bool test() const {
+        static_assert(Index < WordCount * WordBits, "Index out of bounds.");
+        return (m_words[Index / WordBits] & (Word(1) << (Index % WordBits))) != 0;
+    }
+
+    inline constexpr bool test(std::size_t index) const {
+        return (m_words[index / WordBits] & (Word(1) << (index % WordBits))) != 0;
+    }
+
+    inline constexpr void set(std::size_t index) {
+        m_words[index / WordBits] |= (Word(1) << (index % WordBits));
+    }
+
+    inline constexpr void reset(std::size_t index) {
+        m_words[index / WordBits] &= ~(Word(1) << (index % WordBits));
+    }
+
+    inline constexpr bool none() const {
+        Word any = 0;
+        for (const Word word : m_words) {
+            any |= word;
+        }
+        return any == 0;
+    }
+
+    inline constexpr Word word(std::size_t index) const { return m_words[index]; }
+    inline constexpr void setWord(std::size_t index, Word value) { m_words[index] = value; }
+
+    inline constexpr FlagMask& operator|=(const FlagMask& other) {
+        for (std::size_t i = 0; i < WordCount; ++i) {
+            m_words[i] |= other.m_words[i];
+        }
+        return *this;
+    }
+
+    inline constexpr FlagMask& operator&=(const FlagMask& other) {
+        for (std::size_t i = 0; i < WordCount; ++i) {
+            m_words[i] &= other.m_words[i];
+        }
+        return *this;
+    }
+
+    inline constexpr bool operator==(const FlagMask& other) const {
+        for (std::size_t i = 0; i < WordCount; ++i) {
+            if (m_words[i] != other.m_words[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    inline constexpr bool operator!=(const FlagMask& other) const { return !(*this == other); }
+
+private:
+    std::array<Word, WordCount> m_words = {};
+};
+
+#endif /* ___MATH_TRANSFORM_FLAG_MASK_H_ */
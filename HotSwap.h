@@ -0,0 +1,133 @@
+/*
+ * HotSwap.h
+ *
+ * Wait-free parameter publication between one control thread and one worker
+ * thread.
+ *
+ * HotSwap<T> is a triple buffer: the writer edits a private staging copy and
+ * publishes it with a single atomic exchange, the reader picks up the newest
+ * published copy with another exchange. Neither side ever blocks or retries,
+ * and the reader never observes a half-written value.
+ *
+ * LiveTransform wraps a Transform with a HotSwap of its stage objects and
+ * flags. The control thread edits stage()/setFlags() and calls publish(); the
+ * worker applies the newest set at the start of the next process() call, so a
+ * frame (including its post-Break part) always runs with one consistent set.
+ */
+
+#ifndef ___MATH_TRANSFORM_HOT_SWAP_H_
+#define ___MATH_TRANSFORM_HOT_SWAP_H_
+
+#include "Transform.h"
+#include <atomic>
+
+template<typename T>
+class HotSwap {
+public:
+    HotSwap() : HotSwap(T{}) {}
+
+    explicit HotSwap(const T& initial) : m_slots{{initial, initial, initial}} {}
+
+    HotSwap(const HotSwap&) = delete;
+    HotSwap& operator=(const HotSwap&) = delete;
+
+    // Writer side ---------------------------------------------------------
+
+    // Private copy of the last published value, edit it and call publish()
+    inline T& staging() { return m_slots[m_back]; }
+
+    inline void publish() {
+        const u8 published = m_back;
+        m_back = m_middle.exchange(static_cast<u8>(published | Dirty), std::memory_order_acq_rel) & IndexMask;
+
+        // Keep staging() in sync with what was just published. The published
+        // slot is only ever read by the worker, so this read is race-free.
+        m_slots[m_back] = m_slots[published];
+    }
+
+    // Reader side ---------------------------------------------------------
+
+    // Switches to the newest published value, returns true if there was one
+    inline bool consume() {
+        if ((m_middle.load(std::memory_order_relaxed) & Dirty) == 0) {
+            return false;
+        }
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & IndexMask;
+        return true;
+    }
+
+    inline const T& current() const { return m_slots[m_front]; }
+
+private:
+    static constexpr u8 IndexMask = 0x03;
+    static constexpr u8 Dirty = 0x04;
+
+    std::array<T, 3> m_slots;
+    std::atomic<u8> m_middle{2};
+    u8 m_back = 1;   // owned by the writer
+    u8 m_front = 0;  // owned by the reader
+};
+
+// Transform whose stages and flags can be replaced while it is processing
+template<reg N, typename ResultType, bool UseFlags = true, typename... Transforms>
+class LiveTransform {
+public:
+    using FlagsType = typename Transform<N, ResultType, UseFlags, Transforms...>::FlagsType;
+
+    struct Config {
+        std::tuple<Transforms...> transforms;
+        FlagsType flags = {};
+    };
+
+    LiveTransform() : m_config(Config{}) {}
+
+    explicit LiveTransform(Transforms... transforms)
+        : m_engine(transforms...), m_config(Config{std::tuple<Transforms...>(transforms...), FlagsType()}) {}
+
+    // Control thread ------------------------------------------------------
+
+    template<std::size_t Index>
+    inline auto& stage() {
+        static_assert(Index < sizeof...(Transforms), "Index out of bounds.");
+        return std::get<Index>(m_config.staging().transforms);
+    }
+
+    inline void setFlags(const FlagsType& flags) {
+        m_config.staging().flags = flags;
+    }
+
+    inline void publish() {
+        m_config.publish();
+    }
+
+    // Worker thread -------------------------------------------------------
+
+    template<typename Input>
+    bool process(const Input& input) {
+        if (m_config.consume()) {
+            applyConfig(m_config.current(), std::make_index_sequence<sizeof...(Transforms)>{});
+        }
+        return m_engine.process(input);
+    }
+
+    inline std::array<ResultType, N>& results() {
+        return m_engine.results();
+    }
+
+    inline std::array<ResultType, N>& get_array() {
+        return m_engine.get_array();
+    }
+
+private:
+    template<std::size_t... Indices>
+    inline void applyConfig(const Config& config, std::index_sequence<Indices...>) {
+        (..., (m_engine.template get<Indices>() = std::get<Indices>(config.transforms)));
+        m_engine.setFlags(config.flags);
+    }
+
+private:
+    Transform<N, ResultType, UseFlags, Transforms...> m_engine;
+    HotSwap<Config> m_config;
+};
+
+#endif /* ___MATH_TRANSFORM_HOT_SWAP_H_ */
@@ -0,0 +1,263 @@
+/*
+ * Predicates.h
+ *
+ * Branch-free conditional stages. Every condition is a compare whose result
+ * selects one of two already computed values (compare + blend), so the stage
+ * loops stay vectorizable and never mispredict on noisy data. Custom stages
+ * should follow the same pattern: compute both sides, then select with
+ * blend() (or ?: between values that need no arithmetic), never skip work
+ * with if. A plain ?: between computed floating-point values is not enough:
+ * without -fno-trapping-math the compiler moves the arithmetic into a branch
+ * and the loop is no longer vectorized.
+ *
+ * Element stages: Clamp, Threshold, Deadband and Select<Predicate, A, B>.
+ *
+ * Masks: MakeMask<N, Predicate> evaluates a predicate into a caller-owned
+ * Mask<N>, and any later Masked<N, Stage> applies Stage only where that mask
+ * is set. Both are indexed element stages (apply(value, index)): lane i is
+ * written and read in the same per-element chain, so a masked pipeline still
+ * runs Fused, Threaded, Tiled and with ranged results(offset, count). When the
+ * mask is only needed inside the chain, Select<Predicate, A, B> does the same
+ * without a mask.
+ *
+ * The stages keep a pointer to the mask: it must outlive the Transform and
+ * every copy of the stages, and must not be touched by the caller while a
+ * frame is being computed. Readers see the lanes of the last computed range.
+ *
+ *     Mask<N> loud;
+ *     Transform<N, float, true, MakeMask<N, Greater<float>>, Add, Masked<N, Multiply>> transform(
+ *         MakeMask<N, Greater<float>>(loud, Greater<float>(0.5f)), Add(1.0f), Masked<N, Multiply>(loud, Multiply(0.5f)));
+ */
+
+#ifndef ___MATH_TRANSFORM_PREDICATES_H_
+#define ___MATH_TRANSFORM_PREDICATES_H_
+
+#include "Transform.h"
+#include <array>
+#include <cstring>
+
+// first where take is true, second elsewhere, selected with bit masks
+template<typename T>
+inline constexpr T blend(bool take, T first, T second) {
+    if constexpr (std::is_integral_v<T>) {
+        using Bits = std::make_unsigned_t<T>;
+        const Bits mask = Bits(0) - static_cast<Bits>(take);
+        return static_cast<T>((static_cast<Bits>(first) & mask) | (static_cast<Bits>(second) & ~mask));
+    } else if constexpr (std::is_floating_point_v<T> && (sizeof(T) == 4 || sizeof(T) == 8)) {
+        if (TRANSFORM_IS_CONSTANT_EVALUATED()) {
+            return take ? first : second;
+        }
+        using Bits = std::conditional_t<sizeof(T) == 4, u32, u64>;
+        Bits a = 0;
+        Bits b = 0;
+        std::memcpy(&a, &first, sizeof(T));
+        std::memcpy(&b, &second, sizeof(T));
+        const Bits mask = Bits(0) - static_cast<Bits>(take);
+        const Bits bits = (a & mask) | (b & ~mask);
+        T result = T(0);
+        std::memcpy(&result, &bits, sizeof(T));
+        return result;
+    } else {
+        return take ? first : second;
+    }
+}
+
+// Predicates ---------------------------------------------------------------
+
+template<typename T = float>
+class Greater {
+public:
+    Greater() = default;
+    explicit constexpr Greater(T level) : m_level(level) {}
+
+    inline constexpr bool test(T value) const { return value > m_level; }
+
+private:
+    T m_level = T(0);
+};
+
+template<typename T = float>
+class Less {
+public:
+    Less() = default;
+    explicit constexpr Less(T level) : m_level(level) {}
+
+    inline constexpr bool test(T value) const { return value < m_level; }
+
+private:
+    T m_level = T(0);
+};
+
+// low <= value <= high
+template<typename T = float>
+class InRange {
+public:
+    InRange() = default;
+    constexpr InRange(T low, T high) : m_low(low), m_high(high) {}
+
+    inline constexpr bool test(T value) const { return (value >= m_low) & (value <= m_high); }
+
+private:
+    T m_low = T(0);
+    T m_high = T(0);
+};
+
+// Element stages -------------------------------------------------------------
+
+// Leaves the value unchanged (the "else" side of Select)
+class Pass {
+public:
+    template<typename T>
+    inline constexpr T apply(T value) const { return value; }
+};
+
+template<typename T = float>
+class Clamp {
+public:
+    Clamp() = default;
+    constexpr Clamp(T low, T high) : m_low(low), m_high(high) {}
+
+    inline constexpr T apply(T value) const {
+        const T above = value < m_low ? m_low : value;  // maxps / pmaxsd
+        return above > m_high ? m_high : above;         // minps / pminsd
+    }
+
+private:
+    T m_low = T(0);
+    T m_high = T(1);
+};
+
+// Values below level are replaced (by 0 by default)
+template<typename T = float>
+class Threshold {
+public:
+    Threshold() = default;
+    explicit constexpr Threshold(T level, T replacement = T(0)) : m_level(level), m_replacement(replacement) {}
+
+    inline constexpr T apply(T value) const {
+        return value < m_level ? m_replacement : value;
+    }
+
+private:
+    T m_level = T(0);
+    T m_replacement = T(0);
+};
+
+// Values within [-width, width] become 0
+template<typename T = float>
+class Deadband {
+public:
+    Deadband() = default;
+    explicit constexpr Deadband(T width) : m_width(width) {}
+
+    inline constexpr T apply(T value) const {
+        const bool inside = (value >= -m_width) & (value <= m_width);
+        return inside ? T(0) : value;
+    }
+
+private:
+    T m_width = T(0);
+};
+
+// First.apply(value) where the predicate holds, Second.apply(value) elsewhere.
+// Both sides are computed for every element.
+template<typename Predicate, typename First, typename Second = Pass>
+class Select {
+public:
+    Select() = default;
+    constexpr Select(Predicate predicate, First first, Second second = Second())
+        : m_predicate(predicate), m_first(first), m_second(second) {}
+
+    template<typename T>
+    inline constexpr T apply(T value) const {
+        const T first = static_cast<T>(m_first.apply(value));
+        const T second = static_cast<T>(m_second.apply(value));
+        return blend(m_predicate.test(value), first, second);
+    }
+
+    inline constexpr First& first() { return m_first; }
+    inline constexpr Second& second() { return m_second; }
+
+private:
+    Predicate m_predicate = {};
+    First m_first = {};
+    Second m_second = {};
+};
+
+// Masks --------------------------------------------------------------------
+
+// One lane per element, 1 where the predicate held. Owned by the caller and
+// shared by the stages that produce and use it.
+template<reg N>
+class Mask {
+public:
+    inline constexpr u8& operator[](reg index) { return m_lanes[index]; }
+    inline constexpr u8 operator[](reg index) const { return m_lanes[index]; }
+
+    inline constexpr u8* data() { return m_lanes.data(); }
+    inline constexpr const u8* data() const { return m_lanes.data(); }
+    static constexpr reg size() { return N; }
+
+    // Number of set lanes
+    inline constexpr reg count() const {
+        reg set = 0;
+        for (reg i = 0; i < N; ++i) {
+            set += m_lanes[i];
+        }
+        return set;
+    }
+
+    inline constexpr void fill(bool value) {
+        m_lanes.fill(value ? 1 : 0);
+    }
+
+private:
+    std::array<u8, N> m_lanes = {};
+};
+
+// Writes predicate(value) into lane index of the mask, the value is passed through.
+// Without a mask (default-constructed) it does nothing.
+template<reg N, typename Predicate>
+class MakeMask {
+public:
+    MakeMask() = default;
+    MakeMask(Mask<N>& mask, Predicate predicate) : m_mask(&mask), m_predicate(predicate) {}
+
+    template<typename T>
+    inline T apply(T value, reg index) const {
+        if (m_mask != nullptr) {
+            (*m_mask)[index] = m_predicate.test(value) ? 1 : 0;
+        }
+        return value;
+    }
+
+private:
+    Mask<N>* m_mask = nullptr;
+    Predicate m_predicate = {};
+};
+
+// Stage applied only where the mask is set
+template<reg N, typename Stage>
+class Masked {
+public:
+    Masked() = default;
+    Masked(const Mask<N>& mask, Stage stage) : m_mask(&mask), m_stage(stage) {}
+
+    inline constexpr Stage& stage() { return m_stage; }
+
+    // Without a mask the value is passed through
+    template<typename T>
+    inline T apply(T value, reg index) const {
+        if (m_mask == nullptr) {
+            return value;
+        }
+        const T applied = static_cast<T>(m_stage.apply(value));
+        return blend((*m_mask)[index] != 0, applied, value);
+    }
+
+private:
+    const Mask<N>* m_mask = nullptr;
+    Stage m_stage = {};
+};
+
+#endif /* ___MATH_TRANSFORM_PREDICATES_H_ */
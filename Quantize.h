@@ -0,0 +1,162 @@
+/*
+ * Quantize.h
+ *
+ * Terminal output stage: converts the frame to packed integer samples and
+ * writes them straight into a caller-provided byte buffer, so the caller
+ * does not need its own conversion loop over results().
+ *
+ *     std::array<u8, 2 * N> frame;
+ *     Transform<N, float, true, Multiply, Break, Quantize<SampleFormat::Int16>> transform(
+ *         Multiply(0.5f), Break{}, Quantize<SampleFormat::Int16>(frame.data(), frame.size()));
+ *     transform.process(input);
+ *     transform.results();      // frame now holds N little-endian int16 samples
+ *
+ * Full scale is [-1, 1): a value is multiplied by 2^(bits - 1), optionally
+ * TPDF-dithered (+-1 LSB triangular noise), saturated to the integer range
+ * and rounded as selected. Int24 is packed (3 bytes per sample). All formats
+ * are written little-endian. The stage passes values through unchanged.
+ *
+ * Quantize is an indexed element stage (apply(value, index)): sample i goes
+ * to byte i * BytesPerSample, so it runs inside the last pass over the frame
+ * (Fused, Threaded, Tiled and results(offset, count) all work) instead of
+ * adding a pass of its own. apply() is const and the dither noise is a hash
+ * of the sample index, so chunks may run on several threads and in any order.
+ *
+ * Rounding does not depend on the floating-point environment: every mode is
+ * built on a truncating conversion, which ignores the MXCSR / fesetround()
+ * rounding mode, plus a compare on the remainder.
+ */
+
+#ifndef ___MATH_TRANSFORM_QUANTIZE_H_
+#define ___MATH_TRANSFORM_QUANTIZE_H_
+
+#include "basic_types.h"
+#include <type_traits>
+
+enum class SampleFormat : u8 {
+    Int8,
+    Int16,
+    Int24,  // packed, 3 bytes per sample
+    Int32
+};
+
+enum class Rounding : u8 {
+    Nearest,    // to nearest, ties to even
+    Floor,
+    TowardZero
+};
+
+template<SampleFormat Format, typename T = float>
+class Quantize {
+    static_assert(std::is_floating_point_v<T>, "Quantize converts floating-point data.");
+
+    // f32 stays in float for float data, double data is converted in double
+    using Work = std::conditional_t<std::is_same_v<T, f32>, f32, f64>;
+
+public:
+    static constexpr reg Bits = Format == SampleFormat::Int8 ? 8 : Format == SampleFormat::Int16 ? 16 :
+                                Format == SampleFormat::Int24 ? 24 : 32;
+    static constexpr reg BytesPerSample = Bits / 8;
+    static constexpr Work Scale = static_cast<Work>(u64(1) << (Bits - 1));
+    static constexpr Work MinValue = -Scale;
+    // 2^31 - 1 is not a float: the largest float below 2^31 is used for Int32
+    static constexpr Work MaxValue = (Bits == 32 && std::is_same_v<Work, f32>) ? Work(2147483520.0f) : Scale - Work(1);
+
+    Quantize() = default;
+
+    Quantize(u8* output, reg capacity, Rounding rounding = Rounding::Nearest, bool dither = false)
+        : m_rounding(rounding), m_dither(dither) {
+        setOutput(output, capacity);
+    }
+
+    // Output buffer, capacity in bytes; samples that do not fit are dropped
+    inline void setOutput(u8* output, reg capacity) {
+        m_output = output;
+        m_samples = output != nullptr ? capacity / BytesPerSample : 0;
+    }
+
+    inline void setRounding(Rounding rounding) { m_rounding = rounding; }
+    inline void setDither(bool dither) { m_dither = dither; }
+    inline void seed(u32 seed) { m_seed = seed; }
+
+    // Bytes a frame of count samples fills
+    inline reg written(reg count) const {
+        return (count < m_samples ? count : m_samples) * BytesPerSample;
+    }
+
+    // New dither noise for every frame
+    inline void beginFrame() {
+        m_seed = hash(m_seed + 0x9E3779B9U);
+    }
+
+    inline T apply(T value, reg index) const {
+        if (index >= m_samples) {
+            return value;
+        }
+
+        Work scaled = static_cast<Work>(value) * Scale;
+        if (m_dither) {
+            scaled += dither(index);
+        }
+        scaled = scaled < MinValue ? MinValue : scaled;
+        scaled = scaled > MaxValue ? MaxValue : scaled;
+
+        const u32 bits = static_cast<u32>(round(scaled));
+        u8* dst = m_output + index * BytesPerSample;
+        for (reg byte = 0; byte < BytesPerSample; ++byte) {
+            dst[byte] = static_cast<u8>(bits >> (8 * byte));
+        }
+        return value;
+    }
+
+private:
+    // Truncation is exact for every value in range and independent of the
+    // rounding mode; the other modes correct it with a compare
+    inline i32 round(Work value) const {
+        const i32 truncated = static_cast<i32>(value);
+        const Work rest = value - static_cast<Work>(truncated);
+
+        switch (m_rounding) {
+        case Rounding::TowardZero:
+            return truncated;
+        case Rounding::Floor:
+            return truncated - (rest < Work(0) ? 1 : 0);
+        case Rounding::Nearest:
+            break;
+        }
+
+        // floor + fraction in [0, 1), then half to even
+        const i32 low = truncated - (rest < Work(0) ? 1 : 0);
+        const Work fraction = rest < Work(0) ? rest + Work(1) : rest;
+        const bool up = (fraction > Work(0.5)) | ((fraction == Work(0.5)) & ((low & 1) != 0));
+        return low + (up ? 1 : 0);
+    }
+
+    // Triangular noise in (-1, 1) LSB: difference of two uniform values
+    inline Work dither(reg index) const {
+        constexpr Work Unit = Work(1) / Work(4294967296.0);
+        const u32 key = m_seed + static_cast<u32>(index) * 2U;
+        const u32 a = hash(key);
+        const u32 b = hash(key + 1U);
+        return (static_cast<Work>(a) - static_cast<Work>(b)) * Unit;
+    }
+
+    // Integer hash (lowbias32): independent values for neighbouring keys
+    static inline u32 hash(u32 x) {
+        x ^= x >> 16;
+        x *= 0x7FEB352DU;
+        x ^= x >> 15;
+        x *= 0x846CA68BU;
+        x ^= x >> 16;
+        return x;
+    }
+
+private:
+    u8* m_output = nullptr;
+    reg m_samples = 0;          // samples that fit in the output buffer
+    Rounding m_rounding = Rounding::Nearest;
+    bool m_dither = false;
+    u32 m_seed = 0x12345678U;
+};
+
+#endif /* ___MATH_TRANSFORM_QUANTIZE_H_ */
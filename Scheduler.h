@@ -0,0 +1,502 @@
+/*
+ * Scheduler.h
+ *
+ * Shared worker pool for many independent pipelines (any object with
+ * process(input): Transform, SoaTransform, SnapshotTransform, ...), with
+ * different N, stage lists and rates, that become ready at irregular times.
+ *
+ *     Scheduler scheduler;                                  // one worker per core
+ *     auto& iq = scheduler.attach(iqTransform, Priority::High, std::chrono::microseconds(500));
+ *     iq.onDone([](auto& engine, bool ok) { publish(engine.results()); });
+ *     iq.submit(samples);                                   // from any thread, input is copied
+ *     ...
+ *     const LatencyStats stats = iq.stats();                // stats.percentileNs(0.99), stats.missed
+ *
+ * A pipeline runs at most one job at a time and its jobs run in submission
+ * order, because a Transform instance is not thread-safe: jobs wait in the
+ * pipeline's own queue, and the pipeline (not the job) is what gets
+ * scheduled. After each job the pipeline is queued again for its next job.
+ *
+ * Within a priority class pipelines run earliest deadline first: a queued
+ * pipeline is keyed by the absolute deadline of its oldest job (submit time
+ * + the pipeline deadline). Pipelines without a deadline come after those
+ * with one, in queue order, so a busy one cannot starve the others of its
+ * class. A higher class is always taken before a lower one.
+ *
+ * Every worker owns one deadline-ordered heap per priority class. A submit
+ * from a worker thread goes to that worker's heap, other threads spread over
+ * the workers round robin, so submits do not contend on a global queue. An
+ * idle worker looks at the head of every worker's heap of a class and takes
+ * the earliest one, so the order is EDF across the whole pool. The heaps are
+ * mutex-protected: a lock-free (Chase-Lev) deque only pops at its ends and
+ * cannot keep a deadline order.
+ *
+ * Jobs are pooled per pipeline: a finished job goes back to the pipeline's
+ * free list and the next submit() with the same input type reuses it,
+ * assigning the input into the stored one (a std::vector keeps its
+ * capacity), so a steady stream of submits does not allocate.
+ *
+ * Latency is measured from submit() to the end of the job (including the
+ * onDone callback). A pipeline attached with a deadline counts the jobs that
+ * took longer as missed.
+ *
+ * Engines must outlive the scheduler. Jobs still queued when the scheduler is
+ * destroyed are dropped.
+ */
+
+#ifndef ___MATH_TRANSFORM_SCHEDULER_H_
+#define ___MATH_TRANSFORM_SCHEDULER_H_
+
+#include "basic_types.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+enum class Priority : u8 {
+    Realtime,
+    High,
+    Normal,
+    Background
+};
+
+// Per-pipeline latency, in nanoseconds
+struct LatencyStats {
+    static constexpr reg Buckets = 40;  // bucket b counts latencies in [2^(b-1), 2^b)
+
+    u64 jobs = 0;
+    u64 failed = 0;     // process() returned false
+    u64 missed = 0;     // slower than the pipeline deadline
+    u64 totalNs = 0;
+    u64 runNs = 0;      // time spent in process() + onDone
+    u64 maxNs = 0;
+    std::array<u64, Buckets> histogram = {};
+
+    inline f64 meanNs() const { return jobs != 0 ? static_cast<f64>(totalNs) / static_cast<f64>(jobs) : 0.0; }
+
+    // Upper bound of the bucket that holds the given fraction of the jobs (0.99 -> p99)
+    inline u64 percentileNs(f64 fraction) const {
+        const u64 rank = static_cast<u64>(fraction * static_cast<f64>(jobs));
+        u64 seen = 0;
+        for (reg b = 0; b < Buckets; ++b) {
+            seen += histogram[b];
+            if (seen > rank || (seen == jobs && seen != 0)) {
+                return u64(1) << b;
+            }
+        }
+        return maxNs;
+    }
+
+    inline void record(u64 latency, u64 run, bool ok, bool late) {
+        ++jobs;
+        failed += ok ? 0 : 1;
+        missed += late ? 1 : 0;
+        totalNs += latency;
+        runNs += run;
+        maxNs = latency > maxNs ? latency : maxNs;
+
+        reg bucket = 0;
+        while (bucket + 1 < Buckets && (latency >> bucket) != 0) {
+            ++bucket;
+        }
+        ++histogram[bucket];
+    }
+};
+
+template<typename Engine>
+class ScheduledPipeline;
+
+class Scheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr reg Classes = 4;   // one per Priority
+
+    // threads == 0: one worker per hardware thread
+    explicit Scheduler(reg threads = 0) {
+        if (threads == 0) {
+            threads = static_cast<reg>(std::thread::hardware_concurrency());
+        }
+        threads = threads != 0 ? threads : 1;
+
+        m_workers.reserve(threads);
+        for (reg i = 0; i < threads; ++i) {
+            m_workers.emplace_back(new Worker());
+        }
+        for (reg i = 0; i < threads; ++i) {
+            m_workers[i]->thread = std::thread([this, i]() { workerLoop(i); });
+        }
+    }
+
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    ~Scheduler() {
+        {
+            std::lock_guard<std::mutex> lock(m_idleMutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (auto& worker : m_workers) {
+            worker->thread.join();
+        }
+        for (auto& pipeline : m_pipelines) {
+            pipeline->drop();
+        }
+    }
+
+    // Registers an engine; the returned pipeline lives as long as the scheduler.
+    // deadline == 0: latency is recorded but nothing counts as missed.
+    template<typename Engine>
+    ScheduledPipeline<Engine>& attach(Engine& engine, Priority priority = Priority::Normal,
+                                      std::chrono::nanoseconds deadline = std::chrono::nanoseconds(0)) {
+        auto pipeline = std::make_unique<ScheduledPipeline<Engine>>(*this, engine, priority, deadline);
+        ScheduledPipeline<Engine>& result = *pipeline;
+
+        std::lock_guard<std::mutex> lock(m_pipelinesMutex);
+        m_pipelines.push_back(std::move(pipeline));
+        return result;
+    }
+
+    inline reg threads() const { return m_workers.size(); }
+
+    // Blocks until every submitted job has finished
+    void wait() {
+        std::unique_lock<std::mutex> lock(m_idleMutex);
+        m_drained.wait(lock, [this]() { return m_outstanding.load() == 0; });
+    }
+
+protected:
+    template<typename Engine>
+    friend class ScheduledPipeline;
+
+    // Type-erased part of a pipeline: its job queue and statistics
+    class PipelineBase {
+    public:
+        virtual ~PipelineBase() {
+            drop();
+            while (m_free != nullptr) {
+                Job* next = m_free->next;
+                delete m_free;
+                m_free = next;
+            }
+        }
+
+    protected:
+        friend class Scheduler;
+
+        struct Job {
+            explicit Job(const void* type) : kind(type) {}
+            virtual ~Job() = default;
+            virtual bool run() = 0;
+
+            const void* kind;   // one tag per job type, for reuse
+            Clock::time_point submitted;
+            Job* next = nullptr;
+        };
+
+        PipelineBase(Scheduler& owner, Priority priority, std::chrono::nanoseconds deadline)
+            : m_owner(owner), m_priority(priority), m_deadline(deadline) {}
+
+        // Absolute deadline of a job; no deadline sorts after every real one
+        inline Clock::time_point due(const Job* job) const {
+            return m_deadline.count() > 0 ? job->submitted + m_deadline : Clock::time_point::max();
+        }
+
+        // A finished job of this kind from the free list, nullptr if there is none
+        Job* reuse(const void* kind) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (Job** link = &m_free; *link != nullptr; link = &(*link)->next) {
+                Job* job = *link;
+                if (job->kind == kind) {
+                    *link = job->next;
+                    job->next = nullptr;
+                    return job;
+                }
+            }
+            return nullptr;
+        }
+
+        // Adds a job; the first pending job makes the pipeline runnable
+        void enqueue(Job* job) {
+            job->submitted = Clock::now();
+            m_owner.m_outstanding.fetch_add(1);
+
+            bool schedule = false;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                *m_tail = job;
+                m_tail = &job->next;
+                if (!m_queued) {
+                    m_queued = true;
+                    schedule = true;
+                }
+            }
+            if (schedule) {
+                m_owner.push(this, due(job));
+            }
+        }
+
+        // Runs the oldest job; true when more jobs are waiting, next is then their deadline
+        bool runOne(Clock::time_point& next) {
+            Job* job = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                job = m_head;
+                m_head = job->next;
+                if (m_head == nullptr) {
+                    m_tail = &m_head;
+                }
+            }
+
+            const Clock::time_point start = Clock::now();
+            const bool ok = job->run();
+            const Clock::time_point end = Clock::now();
+
+            const u64 latency = static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - job->submitted).count());
+            const u64 run = static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+            const bool late = m_deadline.count() > 0 && latency > static_cast<u64>(m_deadline.count());
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            job->next = m_free;
+            m_free = job;
+            m_stats.record(latency, run, ok, late);
+            m_queued = m_head != nullptr;
+            if (m_queued) {
+                next = due(m_head);
+            }
+            return m_queued;
+        }
+
+        // Queued jobs go to the free list
+        void drop() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            while (m_head != nullptr) {
+                Job* next = m_head->next;
+                m_head->next = m_free;
+                m_free = m_head;
+                m_head = next;
+            }
+            m_tail = &m_head;
+        }
+
+        Scheduler& m_owner;
+        const Priority m_priority;
+        const std::chrono::nanoseconds m_deadline;
+
+        std::mutex m_mutex;
+        Job* m_head = nullptr;
+        Job** m_tail = &m_head;
+        Job* m_free = nullptr;  // finished jobs, reused by submit()
+        bool m_queued = false;  // in some worker heap or running
+        LatencyStats m_stats;
+    };
+
+private:
+    // Queued pipeline: deadline of its oldest job, then queue order
+    struct Entry {
+        Clock::time_point due;
+        u64 sequence = 0;
+        PipelineBase* pipeline = nullptr;
+
+        inline bool before(const Entry& other) const {
+            return due != other.due ? due < other.due : sequence < other.sequence;
+        }
+    };
+
+    // Heap order: the earliest entry at front()
+    static inline bool later(const Entry& a, const Entry& b) {
+        return b.before(a);
+    }
+
+    struct alignas(64) Worker {
+        std::mutex mutex;
+        std::array<std::vector<Entry>, Classes> queues;    // min-heaps
+        std::thread thread;
+    };
+
+    struct Context {
+        const Scheduler* owner = nullptr;
+        reg index = 0;
+    };
+
+    // Worker of this scheduler running on the calling thread, if any
+    static Context& context() {
+        static thread_local Context current;
+        return current;
+    }
+
+    void push(PipelineBase* pipeline, Clock::time_point due) {
+        const Context& current = context();
+        const reg index = current.owner == this ? current.index : m_next.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+        const Entry entry{due, m_sequence.fetch_add(1, std::memory_order_relaxed), pipeline};
+
+        Worker& worker = *m_workers[index];
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            auto& queue = worker.queues[static_cast<reg>(pipeline->m_priority)];
+            queue.push_back(entry);
+            std::push_heap(queue.begin(), queue.end(), later);
+        }
+
+        m_pending.fetch_add(1);
+        if (m_sleeping.load() > 0) {
+            { std::lock_guard<std::mutex> lock(m_idleMutex); }  // a worker about to sleep is inside wait() after this
+            m_wake.notify_one();
+        }
+    }
+
+    // Highest class first; within a class the earliest deadline over all workers
+    PipelineBase* take(reg self) {
+        const reg count = m_workers.size();
+        for (reg c = 0; c < Classes; ++c) {
+            for (;;) {
+                reg best = count;
+                Entry earliest;
+                for (reg k = 0; k < count; ++k) {
+                    const reg index = (self + k) % count;
+                    Worker& worker = *m_workers[index];
+                    std::lock_guard<std::mutex> lock(worker.mutex);
+                    const auto& queue = worker.queues[c];
+                    if (!queue.empty() && (best == count || queue.front().before(earliest))) {
+                        best = index;
+                        earliest = queue.front();
+                    }
+                }
+                if (best == count) {
+                    break;  // class empty
+                }
+
+                Worker& worker = *m_workers[best];
+                std::lock_guard<std::mutex> lock(worker.mutex);
+                auto& queue = worker.queues[c];
+                if (!queue.empty() && queue.front().sequence == earliest.sequence) {
+                    std::pop_heap(queue.begin(), queue.end(), later);
+                    queue.pop_back();
+                    m_pending.fetch_sub(1);
+                    return earliest.pipeline;
+                }
+                // Taken or overtaken meanwhile: look again
+            }
+        }
+        return nullptr;
+    }
+
+    void workerLoop(reg self) {
+        context() = Context{this, self};
+
+        while (!m_stop.load(std::memory_order_relaxed)) {
+            PipelineBase* pipeline = m_pending.load() > 0 ? take(self) : nullptr;
+            if (pipeline == nullptr) {
+                std::unique_lock<std::mutex> lock(m_idleMutex);
+                m_sleeping.fetch_add(1);
+                m_wake.wait(lock, [this]() { return m_pending.load() > 0 || m_stop; });
+                m_sleeping.fetch_sub(1);
+                continue;
+            }
+
+            Clock::time_point next;
+            if (pipeline->runOne(next)) {
+                push(pipeline, next); // more jobs: queued again by the next job's deadline
+            }
+
+            if (m_outstanding.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(m_idleMutex);
+                m_drained.notify_all();
+            }
+        }
+    }
+
+private:
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::atomic<reg> m_next{0};         // round robin for submits from other threads
+    std::atomic<u64> m_sequence{0};     // queue order among equal deadlines
+    std::atomic<i64> m_pending{0};      // pipelines waiting in the deques
+    std::atomic<i64> m_outstanding{0};  // jobs submitted and not finished
+    std::atomic<i32> m_sleeping{0};
+
+    std::mutex m_idleMutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_drained;
+    std::atomic<bool> m_stop{false};
+
+    std::mutex m_pipelinesMutex;
+    std::vector<std::unique_ptr<PipelineBase>> m_pipelines;
+};
+
+// One engine registered with a Scheduler
+template<typename Engine>
+class ScheduledPipeline : public Scheduler::PipelineBase {
+public:
+    using DoneCallback = std::function<void(Engine&, bool)>;
+
+    ScheduledPipeline(Scheduler& owner, Engine& engine, Priority priority, std::chrono::nanoseconds deadline)
+        : PipelineBase(owner, priority, deadline), m_engine(engine) {}
+
+    // Called on the worker after every process(), with its return value.
+    // Set it before the first submit().
+    inline void onDone(DoneCallback done) {
+        m_done = std::move(done);
+    }
+
+    // Queues engine.process(input); the input is copied (or moved) into a pooled job
+    template<typename Input>
+    inline void submit(Input&& input) {
+        using Stored = std::decay_t<Input>;
+        auto* job = static_cast<ProcessJob<Stored>*>(reuse(ProcessJob<Stored>::kind()));
+        if (job != nullptr) {
+            job->input = std::forward<Input>(input);
+        } else {
+            job = new ProcessJob<Stored>(*this, std::forward<Input>(input));
+        }
+        enqueue(job);
+    }
+
+    inline LatencyStats stats() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+    inline void resetStats() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats = LatencyStats();
+    }
+
+    inline Priority priority() const { return m_priority; }
+    inline std::chrono::nanoseconds deadline() const { return m_deadline; }
+
+private:
+    template<typename Input>
+    struct ProcessJob final : Job {
+        template<typename Source>
+        ProcessJob(ScheduledPipeline& owner, Source&& in) : Job(kind()), pipeline(owner), input(std::forward<Source>(in)) {}
+
+        static const void* kind() {
+            static const char tag = 0;
+            return &tag;
+        }
+
+        bool run() override {
+            const bool ok = pipeline.m_engine.process(input);
+            if (pipeline.m_done) {
+                pipeline.m_done(pipeline.m_engine, ok);
+            }
+            return ok;
+        }
+
+        ScheduledPipeline& pipeline;
+        Input input;
+    };
+
+    Engine& m_engine;
+    DoneCallback m_done;
+};
+
+#endif /* ___MATH_TRANSFORM_SCHEDULER_H_ */
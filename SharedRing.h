@@ -0,0 +1,460 @@
+/*
+ * SharedRing.h
+ *
+ * Publishing Transform results to other processes through a POSIX
+ * shared-memory ring (shm_open + mmap), without sockets or per-consumer
+ * copies.
+ *
+ * Layout of the shared object:
+ *
+ *     SharedRingHeader                      (one cache line)
+ *     slot 0: SharedSlotHeader | N results  (each part cache-line aligned)
+ *     slot 1: ...
+ *
+ * Frames are numbered from 1; frame f lives in slot (f - 1) % slots. Each slot
+ * is a seqlock: the writer stores sequence 2f - 1 (odd, being written), runs
+ * the stages directly in the slot's result buffer and then stores 2f. A
+ * reader checks the sequence before and after reading the results; if it is
+ * not 2f both times the frame was overwritten and the read is reported as
+ * failed. Nobody blocks: a slow reader only loses frames (see poll()).
+ *
+ * Writer (one process):
+ *
+ *     SharedRingPublisher<1024, float, true, Multiply, Add> publisher(Multiply(2.0f), Add(1.0f));
+ *     publisher.create("/transform_ring", 8);
+ *     publisher.process(input);
+ *
+ * Readers (any number of processes, results are never copied unless asked):
+ *
+ *     SharedRingReader<float> reader;
+ *     reader.open("/transform_ring");
+ *     reader.readLatest([](u64 frame, Span<const float> results) { ... });
+ *
+ * The callback sees the results in place; its work is discarded (read()
+ * returns false) if the writer overwrote the frame meanwhile, so it should
+ * not act on the data before read() confirms it. Use copy() to keep a frame.
+ *
+ * On glibc before 2.34 link with -lrt.
+ */
+
+#ifndef ___MATH_TRANSFORM_SHARED_RING_H_
+#define ___MATH_TRANSFORM_SHARED_RING_H_
+
+#include "Transform.h"
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TRANSFORM_SHARED_RING_POSIX 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define TRANSFORM_SHARED_RING_POSIX 0
+#endif /* defined(__unix__) || defined(__APPLE__) */
+
+static_assert(std::atomic<u64>::is_always_lock_free, "Shared-memory sequences need lock-free 64-bit atomics.");
+
+namespace shared_ring_detail {
+
+inline constexpr u32 Magic = 0x54524E47U;  // "TRNG"
+inline constexpr u32 Version = 1;
+inline constexpr reg Line = 64;
+
+inline constexpr reg alignUp(reg value) {
+    return (value + Line - 1) / Line * Line;
+}
+
+enum ElementKind : u32 {
+    Unsigned = 0,
+    Signed = 1,
+    Floating = 2
+};
+
+template<typename T>
+inline constexpr u32 elementKind() {
+    return std::is_floating_point_v<T> ? Floating : std::is_signed_v<T> ? Signed : Unsigned;
+}
+
+inline u64 nowNanoseconds() {
+    return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+} // namespace shared_ring_detail
+
+struct alignas(64) SharedRingHeader {
+    u32 magic = 0;
+    u32 version = 0;
+    u32 elementSize = 0;
+    u32 elementKind = 0;
+    u64 frameElements = 0;      // N
+    u64 slotCount = 0;
+    u64 slotStride = 0;         // bytes from one slot header to the next
+    std::atomic<u64> published{0};  // newest complete frame, 0 = none yet
+};
+
+struct alignas(64) SharedSlotHeader {
+    std::atomic<u64> sequence{0};   // 2f - 1 while frame f is written, 2f when done
+    u64 timestamp = 0;              // steady clock, nanoseconds
+};
+
+static_assert(sizeof(SharedRingHeader) == 64 && sizeof(SharedSlotHeader) == 64, "Headers must be one cache line.");
+
+// Shared mapping, owned by publisher and reader alike
+class SharedRingMapping {
+public:
+    SharedRingMapping() = default;
+    SharedRingMapping(const SharedRingMapping&) = delete;
+    SharedRingMapping& operator=(const SharedRingMapping&) = delete;
+
+    ~SharedRingMapping() {
+        close();
+    }
+
+    inline bool isOpen() const { return m_base != nullptr; }
+    inline u8* base() const { return m_base; }
+    inline reg size() const { return m_size; }
+
+    // Always a new object: an existing one with this name (a stale ring, or one
+    // still published) is unlinked first, never resized under its mappings.
+    // Readers of the old object keep their mapping and stop seeing new frames.
+    bool create(const std::string& name, reg size) {
+#if TRANSFORM_SHARED_RING_POSIX
+        close();
+        ::shm_unlink(name.c_str());
+        const int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st = {};
+        if (::fstat(fd, &st) != 0 || ::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            ::close(fd);
+            ::shm_unlink(name.c_str());
+            return false;
+        }
+        void* map = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED) {
+            ::shm_unlink(name.c_str());
+            return false;
+        }
+        m_base = static_cast<u8*>(map);
+        m_size = size;
+        m_name = name;
+        m_device = st.st_dev;
+        m_inode = st.st_ino;
+        m_owner = true;
+        return true;
+#else
+        (void)name; (void)size;
+        return false;
+#endif /* TRANSFORM_SHARED_RING_POSIX */
+    }
+
+    // Read-only mapping of an existing ring
+    bool open(const std::string& name) {
+#if TRANSFORM_SHARED_RING_POSIX
+        close();
+        const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st = {};
+        if (::fstat(fd, &st) != 0 || static_cast<reg>(st.st_size) < sizeof(SharedRingHeader)) {
+            ::close(fd);
+            return false;
+        }
+        void* map = ::mmap(nullptr, static_cast<reg>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED) {
+            return false;
+        }
+        m_base = static_cast<u8*>(map);
+        m_size = static_cast<reg>(st.st_size);
+        m_owner = false;
+        return true;
+#else
+        (void)name;
+        return false;
+#endif /* TRANSFORM_SHARED_RING_POSIX */
+    }
+
+    // The creator also removes the name, unless a newer ring took it over
+    void close() {
+#if TRANSFORM_SHARED_RING_POSIX
+        if (m_base != nullptr) {
+            ::munmap(m_base, m_size);
+            if (m_owner && ownsName()) {
+                ::shm_unlink(m_name.c_str());
+            }
+        }
+#endif /* TRANSFORM_SHARED_RING_POSIX */
+        m_base = nullptr;
+        m_size = 0;
+        m_owner = false;
+    }
+
+private:
+#if TRANSFORM_SHARED_RING_POSIX
+    bool ownsName() const {
+        const int fd = ::shm_open(m_name.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st = {};
+        const bool same = ::fstat(fd, &st) == 0 && st.st_dev == m_device && st.st_ino == m_inode;
+        ::close(fd);
+        return same;
+    }
+
+    dev_t m_device = 0;
+    ino_t m_inode = 0;
+#endif /* TRANSFORM_SHARED_RING_POSIX */
+
+private:
+    u8* m_base = nullptr;
+    reg m_size = 0;
+    std::string m_name;
+    bool m_owner = false;
+};
+
+// Writer side: the stages run directly in the shared slot
+template<reg N, typename ResultType, bool UseFlags = true, typename... Transforms>
+class SharedRingPublisher {
+public:
+    using Shape = Transform<N, ResultType, UseFlags, Transforms...>;
+    using Engine = Transform<1, ResultType, UseFlags, Transforms...>;  // stages and flags only
+    using FlagsType = typename Shape::FlagsType;
+
+    static constexpr reg PayloadBytes = shared_ring_detail::alignUp(N * sizeof(ResultType));
+    static constexpr reg SlotStride = sizeof(SharedSlotHeader) + PayloadBytes;
+
+    SharedRingPublisher() = default;
+
+    explicit SharedRingPublisher(Transforms... transforms) : m_engine(transforms...) {}
+
+    // Creates (or replaces) the shared object, removed again on destruction
+    bool create(const std::string& name, reg slots = 8) {
+        if (slots < 2) {
+            return false;
+        }
+        if (!m_mapping.create(name, sizeof(SharedRingHeader) + slots * SlotStride)) {
+            return false;
+        }
+
+        SharedRingHeader* header = new (m_mapping.base()) SharedRingHeader();
+        header->elementSize = sizeof(ResultType);
+        header->elementKind = shared_ring_detail::elementKind<ResultType>();
+        header->frameElements = N;
+        header->slotCount = slots;
+        header->slotStride = SlotStride;
+        for (reg i = 0; i < slots; ++i) {
+            new (slot(i)) SharedSlotHeader();
+        }
+        header->version = shared_ring_detail::Version;
+        std::atomic_thread_fence(std::memory_order_release);
+        header->magic = shared_ring_detail::Magic;  // readers accept the ring from here on
+
+        m_header = header;
+        m_slots = slots;
+        m_frame = 0;
+        return true;
+    }
+
+    template<std::size_t Index>
+    inline constexpr auto& get() {
+        return m_engine.template get<Index>();
+    }
+
+    inline void setFlags(const FlagsType& flags) {
+        m_engine.setFlags(flags);
+    }
+
+    // Processes one frame straight into the next slot (pre- and post-Break stages)
+    template<typename Input>
+    bool process(const Input& input) {
+        if (m_header == nullptr) {
+            return false;
+        }
+
+        const u64 frame = m_frame + 1;
+        SharedSlotHeader* header = slot((frame - 1) % m_slots);
+        auto& results = *reinterpret_cast<std::array<ResultType, N>*>(payload(header));
+
+        header->sequence.store(2 * frame - 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);  // odd sequence before any payload write
+
+        bool ok = Shape::loadInput(input, results);
+        if (ok) {
+            m_engine.beginFrame();
+            bool active = true;
+            if constexpr (UseFlags) {
+                active = !m_engine.flags().none();
+            }
+            if (active) {
+                m_engine.applyBeforeBreak(results.data(), N);
+                m_engine.applyAfterBreak(results.data(), N);
+            }
+        }
+
+        header->timestamp = shared_ring_detail::nowNanoseconds();
+        header->sequence.store(ok ? 2 * frame : 0, std::memory_order_release);
+        if (!ok) {
+            return false; // slot left invalid, frame number not used
+        }
+
+        m_frame = frame;
+        m_header->published.store(frame, std::memory_order_release);
+        return true;
+    }
+
+    // Frames published so far
+    inline u64 published() const {
+        return m_frame;
+    }
+
+private:
+    inline SharedSlotHeader* slot(reg index) const {
+        return reinterpret_cast<SharedSlotHeader*>(m_mapping.base() + sizeof(SharedRingHeader) + index * SlotStride);
+    }
+
+    static inline u8* payload(SharedSlotHeader* header) {
+        return reinterpret_cast<u8*>(header) + sizeof(SharedSlotHeader);
+    }
+
+private:
+    Engine m_engine;
+    SharedRingMapping m_mapping;
+    SharedRingHeader* m_header = nullptr;
+    reg m_slots = 0;
+    u64 m_frame = 0;
+};
+
+// Reader side, usable from any process. N is taken from the ring header.
+template<typename ResultType>
+class SharedRingReader {
+public:
+    // False if the ring does not exist (yet) or holds another element type
+    bool open(const std::string& name) {
+        if (!m_mapping.open(name)) {
+            return false;
+        }
+
+        m_header = reinterpret_cast<const SharedRingHeader*>(m_mapping.base());
+        const bool valid = m_header->magic == shared_ring_detail::Magic &&
+                           m_header->version == shared_ring_detail::Version &&
+                           m_header->elementSize == sizeof(ResultType) &&
+                           m_header->elementKind == shared_ring_detail::elementKind<ResultType>() &&
+                           m_header->slotCount >= 2 &&
+                           sizeof(SharedRingHeader) + m_header->slotCount * m_header->slotStride <= m_mapping.size();
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (!valid) {
+            close();
+        }
+        return valid;
+    }
+
+    inline void close() {
+        m_mapping.close();
+        m_header = nullptr;
+    }
+
+    inline bool isOpen() const { return m_header != nullptr; }
+
+    inline reg frameElements() const { return static_cast<reg>(m_header->frameElements); }
+    inline reg slotCount() const { return static_cast<reg>(m_header->slotCount); }
+
+    // Newest complete frame, 0 if none was published yet
+    inline u64 latest() const {
+        return m_header->published.load(std::memory_order_acquire);
+    }
+
+    // Calls onFrame(frame, Span<const ResultType>) on the results in place.
+    // False if the frame is not in the ring (not yet written or overwritten)
+    // or was overwritten while the callback ran.
+    template<typename Callback>
+    bool read(u64 frame, Callback&& onFrame, u64* timestamp = nullptr) const {
+        if (frame == 0) {
+            return false;
+        }
+        const SharedSlotHeader* header = slot((frame - 1) % m_header->slotCount);
+
+        if (header->sequence.load(std::memory_order_acquire) != 2 * frame) {
+            return false;
+        }
+        const u64 stamp = header->timestamp;
+        onFrame(frame, Span<const ResultType>(reinterpret_cast<const ResultType*>(payload(header)), frameElements()));
+
+        std::atomic_thread_fence(std::memory_order_acquire);  // payload reads before the second check
+        if (header->sequence.load(std::memory_order_relaxed) != 2 * frame) {
+            return false;
+        }
+        if (timestamp != nullptr) {
+            *timestamp = stamp;
+        }
+        return true;
+    }
+
+    template<typename Callback>
+    inline bool readLatest(Callback&& onFrame) const {
+        return read(latest(), std::forward<Callback>(onFrame));
+    }
+
+    // Copies frame into dst (frameElements() values), false as for read()
+    inline bool copy(u64 frame, ResultType* dst) const {
+        return read(frame, [dst](u64, Span<const ResultType> results) {
+            for (reg i = 0; i < results.size(); ++i) {
+                dst[i] = results[i];
+            }
+        });
+    }
+
+    // Reads every frame after cursor up to latest() and advances cursor.
+    // Returns the number of frames read; frames that were overwritten before
+    // they could be read are added to lost.
+    template<typename Callback>
+    reg poll(u64& cursor, Callback&& onFrame, u64* lost = nullptr) const {
+        const u64 newest = latest();
+        if (newest <= cursor) {
+            return 0;
+        }
+
+        // Frames older than the ring are gone already
+        u64 next = cursor + 1;
+        const u64 oldest = newest > m_header->slotCount ? newest - m_header->slotCount + 1 : 1;
+        if (next < oldest) {
+            if (lost != nullptr) *lost += oldest - next;
+            next = oldest;
+        }
+
+        reg frames = 0;
+        for (; next <= newest; ++next) {
+            if (read(next, onFrame)) {
+                ++frames;
+            } else if (lost != nullptr) {
+                ++*lost;
+            }
+        }
+        cursor = newest;
+        return frames;
+    }
+
+private:
+    inline const SharedSlotHeader* slot(u64 index) const {
+        return reinterpret_cast<const SharedSlotHeader*>(m_mapping.base() + sizeof(SharedRingHeader) + index * m_header->slotStride);
+    }
+
+    static inline const u8* payload(const SharedSlotHeader* header) {
+        return reinterpret_cast<const u8*>(header) + sizeof(SharedSlotHeader);
+    }
+
+private:
+    SharedRingMapping m_mapping;
+    const SharedRingHeader* m_header = nullptr;
+};
+
+#endif /* ___MATH_TRANSFORM_SHARED_RING_H_ */
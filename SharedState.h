@@ -0,0 +1,125 @@
+/*
+ * SharedState.h
+ *
+ * Immutable stage state shared between pipelines. Stages are held by value
+ * in the Transform tuple, so a stage that owns a large table (FIR
+ * coefficients, a LUT, FFT twiddles) is copied with every addTransform(),
+ * every pipeline clone and every ChannelBank channel. SharedState<T> is a
+ * reference-counted handle to a const T: copying a stage copies a pointer,
+ * and all copies read the same table.
+ *
+ *     auto curve = SharedState<LutTable<float>>::make(LutTable<float>::build(4096, 0.0f, 1.0f, gamma));
+ *     Transform<N, float, true, Lut<float>> left(Lut<float>(curve)), right(Lut<float>(curve));
+ *
+ * The state is never modified after make(); to change it, build a new one and
+ * hand it to the stage (e.g. through HotSwap). Stages should keep the raw
+ * pointer from get() for their element loop: it costs nothing, while copying
+ * the handle itself is an atomic increment.
+ *
+ * Lut is the example stage: a lookup table with linear interpolation.
+ */
+
+#ifndef ___MATH_TRANSFORM_SHARED_STATE_H_
+#define ___MATH_TRANSFORM_SHARED_STATE_H_
+
+#include "basic_types.h"
+#include <memory>
+#include <utility>
+#include <vector>
+
+template<typename T>
+class SharedState {
+public:
+    SharedState() = default;
+
+    explicit SharedState(std::shared_ptr<const T> state) : m_state(std::move(state)) {}
+
+    // Builds the state once; every copy of the handle refers to it
+    template<typename... Args>
+    static SharedState make(Args&&... args) {
+        return SharedState(std::make_shared<const T>(std::forward<Args>(args)...));
+    }
+
+    inline const T* get() const { return m_state.get(); }
+    inline const T& operator*() const { return *m_state; }
+    inline const T* operator->() const { return m_state.get(); }
+    explicit operator bool() const { return m_state != nullptr; }
+
+    // Number of handles (stages, pipelines) sharing the state
+    inline long useCount() const { return m_state.use_count(); }
+
+private:
+    std::shared_ptr<const T> m_state;
+};
+
+// Samples of a function over [low, high]
+template<typename T = float>
+struct LutTable {
+    T low = T(0);
+    T step = T(1);              // input distance between two entries
+    std::vector<T> values;      // size() + 1 entries, the last one repeated
+
+    template<typename Function>
+    static LutTable build(reg size, T low, T high, Function&& function) {
+        LutTable table;
+        size = size < 2 ? 2 : size;
+        table.low = low;
+        table.step = (high - low) / static_cast<T>(size - 1);
+        table.values.resize(size + 1);
+        for (reg i = 0; i < size; ++i) {
+            table.values[i] = static_cast<T>(function(low + table.step * static_cast<T>(i)));
+        }
+        table.values[size] = table.values[size - 1];
+        return table;
+    }
+
+    inline reg size() const { return values.empty() ? 0 : values.size() - 1; }
+};
+
+// Table lookup with linear interpolation, inputs outside [low, high] are clamped.
+// A default-constructed Lut has no table and passes values through.
+template<typename T = float>
+class Lut {
+public:
+    Lut() = default;
+
+    explicit Lut(SharedState<LutTable<T>> table) {
+        setTable(std::move(table));
+    }
+
+    inline void setTable(SharedState<LutTable<T>> table) {
+        m_table = std::move(table);
+        m_values = nullptr;
+        if (m_table && m_table->size() >= 2) {
+            m_values = m_table->values.data();
+            m_low = m_table->low;
+            m_inverseStep = T(1) / m_table->step;
+            m_last = static_cast<T>(m_table->size() - 1);
+        }
+    }
+
+    inline const SharedState<LutTable<T>>& table() const { return m_table; }
+
+    inline T apply(T value) const {
+        if (m_values == nullptr) {
+            return value;
+        }
+        T position = (value - m_low) * m_inverseStep;
+        position = !(position >= T(0)) ? T(0) : position;  // NaN goes to the first entry
+        position = position > m_last ? m_last : position;
+
+        // The repeated last entry keeps index + 1 in range at the upper end
+        const reg index = static_cast<reg>(position);
+        const T fraction = position - static_cast<T>(index);
+        return m_values[index] + (m_values[index + 1] - m_values[index]) * fraction;
+    }
+
+private:
+    SharedState<LutTable<T>> m_table;
+    const T* m_values = nullptr;
+    T m_low = T(0);
+    T m_inverseStep = T(1);
+    T m_last = T(0);
+};
+
+#endif /* ___MATH_TRANSFORM_SHARED_STATE_H_ */
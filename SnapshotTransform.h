@@ -0,0 +1,293 @@
+/*
+ * SnapshotTransform.h
+ *
+ * One writer, any number of readers: finished frames are published as
+ * immutable, reference-counted snapshots.
+ *
+ * The writer runs process() as usual. Every frame gets its own slot from a
+ * small pool: the pre-Break stages run on the writer thread, then the slot
+ * becomes the latest frame. Readers call latest() and get a Snapshot handle
+ * that keeps the slot alive (reference count) while the writer moves on to
+ * the next frame in another slot. Nothing is copied and no lock is taken.
+ *
+ * The post-Break stages run lazily on the first reader that asks for
+ * results(), exactly once per frame: an atomic state (Pending -> Computing
+ * -> Ready) elects one reader to compute, the others wait for it. Because
+ * several readers may compute different frames at the same time, post-Break
+ * stages must be element stages with a const apply().
+ *
+ * Flags are captured per frame. Stage parameters may be changed from the
+ * writer thread for pre-Break stages only; post-Break stages are read by the
+ * readers and must not change after construction.
+ *
+ *     SnapshotTransform<1024, float, true, Multiply, Break, Add> live(Multiply(2.0f), Break{}, Add(1.0f));
+ *     // writer:  live.process(input);
+ *     // readers: auto frame = live.latest(); if (frame) draw(frame.results());
+ *
+ * When every slot is held by readers, process() drops the frame and returns
+ * false; use more Frames if readers hold snapshots for long.
+ */
+
+#ifndef ___MATH_TRANSFORM_SNAPSHOT_TRANSFORM_H_
+#define ___MATH_TRANSFORM_SNAPSHOT_TRANSFORM_H_
+
+#include "Transform.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+
+// Frames is the slot pool size, see SnapshotTransform below for the default
+template<reg N, typename ResultType, bool UseFlags, reg Frames, typename... Transforms>
+class SnapshotTransformBase {
+    static_assert(Frames >= 2, "At least two frames are needed: one published, one being written.");
+
+public:
+    using Shape = Transform<N, ResultType, UseFlags, Transforms...>;
+    using Engine = Transform<1, ResultType, UseFlags, Transforms...>;  // stages and flags only
+    using FlagsType = typename Shape::FlagsType;
+    using Data = std::array<ResultType, N>;
+
+private:
+    static constexpr u32 Claimed = 0x80000000U;     // refs bit: slot is being written
+    static constexpr u32 None = 0xFFFFFFFFU;
+
+    enum State : u8 {
+        Pending,    // post-Break stages not run yet
+        Computing,  // one reader is running them
+        Ready
+    };
+
+    struct alignas(64) Frame {
+        Data before = {};   // pre-Break results
+        Data after = {};    // final results (post-Break stages)
+        FlagsType flags = {};
+        u64 generation = 0;
+        std::atomic<u32> refs{0};
+        std::atomic<u8> state{Ready};
+    };
+
+    template<std::size_t... Indices>
+    static constexpr bool constAfterBreak(std::index_sequence<Indices...>) {
+        return (true && ... && isConstStage<std::tuple_element_t<Shape::BreakIndex + 1 + Indices, std::tuple<Transforms...>>>());
+    }
+
+    template<typename Stage>
+    static constexpr bool isConstStage() {
+        return std::is_same_v<Stage, Break> || (is_const_stage_v<Stage, ResultType> && !is_block_stage_v<Stage, ResultType>);
+    }
+
+public:
+    static constexpr bool HasAfterBreak = Shape::BreakExists && Shape::AfterBreakCount > 0;
+
+    static_assert(constAfterBreak(std::make_index_sequence<Shape::AfterBreakCount>{}),
+                  "Post-Break stages run on reader threads: they must be element stages with a const apply().");
+
+    // Reference-counted handle to one published frame
+    class Snapshot {
+    public:
+        Snapshot() = default;
+
+        Snapshot(const Snapshot& other) : m_owner(other.m_owner), m_frame(other.m_frame) {
+            if (m_frame != nullptr) {
+                m_frame->refs.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        Snapshot(Snapshot&& other) noexcept : m_owner(other.m_owner), m_frame(other.m_frame) {
+            other.m_owner = nullptr;
+            other.m_frame = nullptr;
+        }
+
+        Snapshot& operator=(Snapshot other) noexcept {
+            std::swap(m_owner, other.m_owner);
+            std::swap(m_frame, other.m_frame);
+            return *this;
+        }
+
+        ~Snapshot() {
+            if (m_frame != nullptr) {
+                m_frame->refs.fetch_sub(1, std::memory_order_release);
+            }
+        }
+
+        explicit operator bool() const { return m_frame != nullptr; }
+
+        // Frame number, counted from 1
+        inline u64 generation() const { return m_frame->generation; }
+
+        // Results before Break
+        inline const Data& get_array() const { return m_frame->before; }
+
+        // Final results; the first caller for this frame runs the post-Break stages
+        inline const Data& results() const {
+            if constexpr (HasAfterBreak) {
+                m_owner->finish(*m_frame);
+                return m_frame->after;
+            } else {
+                return m_frame->before;
+            }
+        }
+
+    private:
+        friend class SnapshotTransformBase;
+
+        Snapshot(SnapshotTransformBase* owner, Frame* frame) : m_owner(owner), m_frame(frame) {}
+
+        SnapshotTransformBase* m_owner = nullptr;
+        Frame* m_frame = nullptr;
+    };
+
+    SnapshotTransformBase() : m_frames(new Frame[Frames]) {}
+
+    explicit SnapshotTransformBase(Transforms... transforms) : m_engine(transforms...), m_frames(new Frame[Frames]) {}
+
+    SnapshotTransformBase(const SnapshotTransformBase&) = delete;
+    SnapshotTransformBase& operator=(const SnapshotTransformBase&) = delete;
+
+    // Writer thread -------------------------------------------------------
+
+    template<std::size_t Index>
+    inline constexpr auto& get() {
+        return m_engine.template get<Index>();
+    }
+
+    inline void setFlags(const FlagsType& flags) {
+        m_engine.setFlags(flags);
+    }
+
+    // Processes one frame into a free slot and publishes it
+    template<typename Input>
+    bool process(const Input& input) {
+        Frame* frame = claim();
+        if (frame == nullptr) {
+            return false; // every slot is held by readers
+        }
+
+        if (!Shape::loadInput(input, frame->before)) {
+            frame->refs.fetch_and(~Claimed, std::memory_order_release);
+            return false;
+        }
+
+        m_engine.beginFrame();
+        const FlagsType& flags = m_engine.flags();
+        bool active = true;
+        if constexpr (UseFlags) {
+            active = !flags.none();
+        }
+        if (active) {
+            m_engine.applyBeforeBreak(frame->before.data(), N);
+        }
+
+        if constexpr (HasAfterBreak) {
+            if (!active) {
+                frame->after = frame->before; // nothing to compute, publish as Ready
+            }
+        }
+
+        frame->flags = flags;
+        frame->generation = ++m_generation;
+        frame->state.store(HasAfterBreak && active ? Pending : Ready, std::memory_order_relaxed);
+
+        m_latest.store(static_cast<u32>(frame - m_frames.get()), std::memory_order_release);
+        frame->refs.fetch_and(~Claimed, std::memory_order_release);
+        return true;
+    }
+
+    // Frames published so far
+    inline u64 generation() const {
+        return m_generation;
+    }
+
+    // Reader threads ------------------------------------------------------
+
+    // Latest published frame (empty before the first process())
+    Snapshot latest() {
+        for (;;) {
+            const u32 index = m_latest.load(std::memory_order_acquire);
+            if (index == None) {
+                return Snapshot();
+            }
+
+            Frame& frame = m_frames[index];
+            const u32 refs = frame.refs.fetch_add(1, std::memory_order_acq_rel);
+
+            // The slot may have been claimed for a new frame between the two loads
+            if ((refs & Claimed) == 0 && m_latest.load(std::memory_order_acquire) == index) {
+                return Snapshot(this, &frame);
+            }
+            frame.refs.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+private:
+    // A slot that is neither the latest frame nor held by a reader
+    Frame* claim() {
+        const u32 latest = m_latest.load(std::memory_order_relaxed);
+        for (reg i = 0; i < Frames; ++i) {
+            const reg index = (m_next + i) % Frames;
+            if (index == latest) {
+                continue;
+            }
+            u32 expected = 0;
+            if (m_frames[index].refs.compare_exchange_strong(expected, Claimed, std::memory_order_acquire, std::memory_order_relaxed)) {
+                m_next = index + 1;
+                return &m_frames[index];
+            }
+        }
+        return nullptr;
+    }
+
+    void finish(Frame& frame) {
+        u8 state = frame.state.load(std::memory_order_acquire);
+        if (state == Ready) {
+            return;
+        }
+
+        if (state == Pending && frame.state.compare_exchange_strong(state, Computing, std::memory_order_acquire)) {
+            frame.after = frame.before;
+            applyAfterBreak(frame, std::make_index_sequence<Shape::AfterBreakCount>{});
+            frame.state.store(Ready, std::memory_order_release);
+            return;
+        }
+
+        // Another reader is computing this frame
+        while (frame.state.load(std::memory_order_acquire) != Ready) {
+            std::this_thread::yield();
+        }
+    }
+
+    template<std::size_t... Indices>
+    inline void applyAfterBreak(Frame& frame, std::index_sequence<Indices...>) {
+        (..., applyStage<Shape::BreakIndex + 1 + Indices>(frame));
+    }
+
+    template<std::size_t Index>
+    inline void applyStage(Frame& frame) {
+        using Stage = std::tuple_element_t<Index, std::tuple<Transforms...>>;
+
+        if constexpr (!std::is_same_v<Stage, Break>) {
+            if constexpr (UseFlags) {
+                if (!frame.flags.template test<Index>()) {
+                    return;
+                }
+            }
+            const Stage& stage = m_engine.template get<Index>();
+            for (reg i = 0; i < N; ++i) {
+                frame.after[i] = applyAt(stage, frame.after[i], i);
+            }
+        }
+    }
+
+private:
+    Engine m_engine;
+    std::unique_ptr<Frame[]> m_frames;
+    std::atomic<u32> m_latest{None};
+    u64 m_generation = 0;   // writer only
+    reg m_next = 0;         // writer only: where the next slot search starts
+};
+
+// Default pool of four frames
+template<reg N, typename ResultType, bool UseFlags = true, typename... Transforms>
+using SnapshotTransform = SnapshotTransformBase<N, ResultType, UseFlags, 4, Transforms...>;
+
+#endif /* ___MATH_TRANSFORM_SNAPSHOT_TRANSFORM_H_ */
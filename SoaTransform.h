@@ -0,0 +1,456 @@
+/*
+ * SoaTransform.h
+ *
+ * Transform for complex and small-vector elements (I/Q samples, 3-axis
+ * sensor data). Transform itself only takes arithmetic element types;
+ * SoaTransform keeps the same stage tuple, flags and Break handling but
+ * stores the frame as structure-of-arrays: one contiguous array per lane
+ * (real / imaginary, x / y / z). Every stage loop reads and writes the lanes
+ * side by side, so it vectorizes across elements like a scalar pipeline.
+ *
+ * Element types: std::complex<T> (2 lanes) and Vec<T, K> (K lanes). Stages
+ * either take the whole element,
+ *
+ *     std::complex<float> apply(std::complex<float> value) const;
+ *
+ * or a single scalar, in which case they run on every lane (Multiply scales
+ * both I and Q). A stage that takes both a whole element and a scalar (a
+ * generic template<typename T> T apply(T)) is taken as a scalar stage: its
+ * body is not visible to the detection and usually only works on scalars.
+ * Stages that reduce an element to a real value (Magnitude, Phase) leave it
+ * in lane 0 and clear the others.
+ *
+ * A stage may also take the whole frame, lane arrays and all:
+ *
+ *     template<typename T, std::size_t N, std::size_t K>
+ *     void applyLanes(std::array<std::array<T, N>, K>& lanes) const;
+ *
+ * which SoaTransform calls instead of any element loop.
+ *
+ *     SoaTransform<1024, std::complex<float>, true, ComplexMultiply<float>, Break, Magnitude> iq(
+ *         ComplexMultiply<float>({0.0f, 1.0f}), Break{}, Magnitude{});
+ *     iq.process(samples);                 // interleaved std::complex<float> input
+ *     const auto& power = iq.results()[0]; // lane 0
+ *
+ * Complex arithmetic is written out instead of using std::complex operators:
+ * operator* handles inf/nan through a library call (__mulsc3) that stops
+ * vectorization.
+ *
+ * Magnitude runs through applyLanes(): the sum of squares is a plain loop,
+ * the square roots use the SSE / AVX / NEON sqrt instructions directly.
+ * Without -fno-math-errno, which the project does not set, std::sqrt keeps
+ * an errno branch that stops the loop from vectorizing, and GCC's optimize
+ * pragma cannot remove it for a single header.
+ */
+
+#ifndef ___MATH_TRANSFORM_SOA_TRANSFORM_H_
+#define ___MATH_TRANSFORM_SOA_TRANSFORM_H_
+
+#include "Transform.h"
+#include "Predicates.h"
+#include <cmath>
+#include <complex>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+// Small fixed-size vector element
+template<typename T, reg K>
+struct Vec {
+    static_assert(std::is_arithmetic_v<T> && K > 0, "Vec needs an arithmetic type and at least one lane.");
+
+    std::array<T, K> v = {};
+
+    inline constexpr T& operator[](reg index) { return v[index]; }
+    inline constexpr const T& operator[](reg index) const { return v[index]; }
+
+    inline constexpr bool operator==(const Vec& other) const { return v == other.v; }
+    inline constexpr bool operator!=(const Vec& other) const { return v != other.v; }
+};
+
+// Lane layout of an element type
+template<typename E>
+struct soa_traits;
+
+template<typename T>
+struct soa_traits<std::complex<T>> {
+    using Scalar = T;
+    static constexpr reg Lanes = 2;
+
+    template<reg Lane>
+    static constexpr T get(const std::complex<T>& value) {
+        if constexpr (Lane == 0) {
+            return value.real();
+        } else {
+            return value.imag();
+        }
+    }
+
+    static constexpr std::complex<T> make(const T* lanes) {
+        return std::complex<T>(lanes[0], lanes[1]);
+    }
+};
+
+template<typename T, reg K>
+struct soa_traits<Vec<T, K>> {
+    using Scalar = T;
+    static constexpr reg Lanes = K;
+
+    template<reg Lane>
+    static constexpr T get(const Vec<T, K>& value) {
+        return value.v[Lane];
+    }
+
+    static constexpr Vec<T, K> make(const T* lanes) {
+        Vec<T, K> value;
+        for (reg k = 0; k < K; ++k) {
+            value.v[k] = lanes[k];
+        }
+        return value;
+    }
+};
+
+// Template to check if stage.apply(Arg) exists and returns something convertible to Result
+template <typename Stage, typename Arg, typename Result, typename = void>
+struct applies_to : std::false_type {};
+
+template <typename Stage, typename Arg, typename Result>
+struct applies_to<Stage, Arg, Result, std::void_t<decltype(std::declval<Stage&>().apply(std::declval<Arg>()))>>
+    : std::bool_constant<std::is_convertible_v<decltype(std::declval<Stage&>().apply(std::declval<Arg>())), Result>> {};
+
+// Template to check if a stage takes the whole element (otherwise it is applied per lane).
+// A stage that also maps a scalar to a scalar is generic and runs per lane.
+template <typename Stage, typename E>
+inline constexpr bool is_element_stage_v =
+    applies_to<Stage, E, E>::value &&
+    !applies_to<Stage, typename soa_traits<E>::Scalar, typename soa_traits<E>::Scalar>::value;
+
+template <typename Stage, typename E>
+struct is_element_stage : std::bool_constant<is_element_stage_v<Stage, E>> {};
+
+// Template to check if a stage works on the whole lane arrays
+template <typename Stage, typename Data, typename = void>
+struct is_lane_stage : std::false_type {};
+
+template <typename Stage, typename Data>
+struct is_lane_stage<Stage, Data, std::void_t<decltype(std::declval<Stage&>().applyLanes(std::declval<Data&>()))>>
+    : std::true_type {};
+
+template <typename Stage, typename Data>
+inline constexpr bool is_lane_stage_v = is_lane_stage<Stage, Data>::value;
+
+namespace soa_detail {
+
+// data[i] = sqrt(data[i]) for N values with the sqrt instruction: std::sqrt
+// sets errno, and its error branch keeps the loop scalar. Only the last
+// N % width values go through std::sqrt.
+template<reg N, typename T>
+inline void sqrtInPlace(T* data) {
+    reg i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+    if constexpr (std::is_same_v<T, f32>) {
+#if defined(__AVX__)
+        for (; i < N - N % 8; i += 8) {
+            _mm256_storeu_ps(data + i, _mm256_sqrt_ps(_mm256_loadu_ps(data + i)));
+        }
+#endif /* defined(__AVX__) */
+        for (; i < N - N % 4; i += 4) {
+            _mm_storeu_ps(data + i, _mm_sqrt_ps(_mm_loadu_ps(data + i)));
+        }
+    } else if constexpr (std::is_same_v<T, f64>) {
+        for (; i < N - N % 2; i += 2) {
+            _mm_storeu_pd(data + i, _mm_sqrt_pd(_mm_loadu_pd(data + i)));
+        }
+    }
+#elif defined(__aarch64__)
+    if constexpr (std::is_same_v<T, f32>) {
+        for (; i < N - N % 4; i += 4) {
+            vst1q_f32(data + i, vsqrtq_f32(vld1q_f32(data + i)));
+        }
+    } else if constexpr (std::is_same_v<T, f64>) {
+        for (; i < N - N % 2; i += 2) {
+            vst1q_f64(data + i, vsqrtq_f64(vld1q_f64(data + i)));
+        }
+    }
+#endif
+    for (; i < N; ++i) {
+        data[i] = static_cast<T>(std::sqrt(data[i]));
+    }
+}
+
+} // namespace soa_detail
+
+// Main SoaTransform class
+template<reg N, typename ElementType, bool UseFlags = true, typename... Transforms>
+class SoaTransform {
+public:
+    using Traits = soa_traits<ElementType>;
+    using Scalar = typename Traits::Scalar;
+    static constexpr reg Lanes = Traits::Lanes;
+
+    // Same flags and Break rules as Transform
+    using Plan = StagePlan<Transforms...>;
+    using FlagsType = FlagMask<sizeof...(Transforms)>;
+    using LaneArray = std::array<Scalar, N>;
+    using Data = std::array<LaneArray, Lanes>;
+
+    SoaTransform() = default;
+
+    explicit SoaTransform(Transforms... transforms) : m_transforms(transforms...) {}
+
+    template<std::size_t Index>
+    inline constexpr auto& get() {
+        static_assert(Index < sizeof...(Transforms), "Index out of bounds.");
+        return std::get<Index>(m_transforms);
+    }
+
+    inline constexpr void setFlags(const FlagsType& flags) {
+        if constexpr (UseFlags) {
+            m_flags = flags;
+            m_postBreakComputed = false;
+        }
+    }
+
+    inline constexpr const FlagsType& flags() const {
+        return m_flags;
+    }
+
+    // Interleaved elements: std::array / std::vector / Span / C array of ElementType
+    template<typename Input>
+    bool process(const Input& input) {
+        m_postBreakComputed = false;
+
+        if constexpr (std::is_array_v<Input>) {
+            if constexpr (std::extent_v<Input> < N) {
+                return false;
+            }
+            deinterleave(std::data(input), std::make_index_sequence<Lanes>{});
+        } else if constexpr (is_std_vector_v<Input> || is_std_array_v<Input> ||
+                             std::is_same_v<Input, Span<typename Input::value_type>>) {
+            static_assert(std::is_same_v<std::remove_cv_t<typename Input::value_type>, ElementType>,
+                          "Input elements must be ElementType.");
+            if (input.size() < N) {
+                return false;
+            }
+            deinterleave(input.data(), std::make_index_sequence<Lanes>{});
+        } else {
+            return false;
+        }
+
+        runStages();
+        return true;
+    }
+
+    // Input already split into lanes (lanes[k] points to N values of lane k)
+    bool processLanes(const Scalar* const* lanes) {
+        m_postBreakComputed = false;
+        for (reg k = 0; k < Lanes; ++k) {
+            std::memcpy(m_data[k].data(), lanes[k], N * sizeof(Scalar));
+        }
+        runStages();
+        return true;
+    }
+
+    // Final results, one array per lane
+    inline Data& results() {
+        if constexpr (Plan::HasAfterBreak) {
+            if (!m_postBreakComputed) {
+                Plan::forEachAfterBreak([this](auto index) { applyStage<decltype(index)::value>(); });
+                m_postBreakComputed = true;
+            }
+        }
+        return m_data;
+    }
+
+    // Results before Break
+    inline constexpr Data& get_array() {
+        return m_data;
+    }
+
+    // One element of the current data (no post-Break evaluation)
+    inline ElementType value(reg index) const {
+        Scalar lanes[Lanes];
+        for (reg k = 0; k < Lanes; ++k) {
+            lanes[k] = m_data[k][index];
+        }
+        return Traits::make(lanes);
+    }
+
+    // Interleaves the final results into out (N elements)
+    inline void copyResults(ElementType* out) {
+        results();
+        for (reg i = 0; i < N; ++i) {
+            out[i] = value(i);
+        }
+    }
+
+private:
+    template<typename T, std::size_t... Lane>
+    inline void deinterleave(const T* src, std::index_sequence<Lane...>) {
+        for (reg i = 0; i < N; ++i) {
+            const ElementType element = static_cast<ElementType>(src[i]);
+            ((m_data[Lane][i] = Traits::template get<Lane>(element)), ...);
+        }
+    }
+
+    inline void runStages() {
+        if constexpr (UseFlags) {
+            if (m_flags.none()) return;
+        }
+        Plan::forEachBeforeBreak([this](auto index) { applyStage<decltype(index)::value>(); });
+    }
+
+    // Break is never passed here (StagePlan skips it)
+    template<std::size_t Index>
+    inline void applyStage() {
+        using Stage = std::tuple_element_t<Index, std::tuple<Transforms...>>;
+
+        if constexpr (UseFlags) {
+            if (!m_flags.template test<Index>()) {
+                return;
+            }
+        }
+
+        auto& stage = std::get<Index>(m_transforms);
+        if constexpr (is_lane_stage_v<Stage, Data>) {
+            stage.applyLanes(m_data);
+        } else if constexpr (is_element_stage_v<Stage, ElementType>) {
+            applyElementStage(stage, std::make_index_sequence<Lanes>{});
+        } else {
+            // Scalar stage: the same loop on every lane
+            for (reg k = 0; k < Lanes; ++k) {
+                Scalar* lane = m_data[k].data();
+                for (reg i = 0; i < N; ++i) {
+                    lane[i] = static_cast<Scalar>(stage.apply(lane[i]));
+                }
+            }
+        }
+    }
+
+    template<typename Stage, std::size_t... Lane>
+    inline void applyElementStage(Stage& stage, std::index_sequence<Lane...>) {
+        Scalar* lanes[Lanes] = {m_data[Lane].data()...};
+        for (reg i = 0; i < N; ++i) {
+            const Scalar values[Lanes] = {lanes[Lane][i]...};
+            const ElementType result = static_cast<ElementType>(stage.apply(Traits::make(values)));
+            ((lanes[Lane][i] = Traits::template get<Lane>(result)), ...);
+        }
+    }
+
+private:
+    Data m_data = {};
+    std::tuple<Transforms...> m_transforms;
+    FlagsType m_flags = {};
+    bool m_postBreakComputed = false;
+};
+
+// Complex / vector stages ----------------------------------------------------
+
+// z * factor, written out (see the note at the top)
+template<typename T = float>
+class ComplexMultiply {
+public:
+    ComplexMultiply() = default;
+    explicit constexpr ComplexMultiply(std::complex<T> factor) : m_re(factor.real()), m_im(factor.imag()) {}
+
+    inline constexpr std::complex<T> apply(std::complex<T> value) const {
+        const T re = value.real();
+        const T im = value.imag();
+        return std::complex<T>(re * m_re - im * m_im, re * m_im + im * m_re);
+    }
+
+private:
+    T m_re = T(1);
+    T m_im = T(0);
+};
+
+class Conjugate {
+public:
+    template<typename T>
+    inline constexpr std::complex<T> apply(std::complex<T> value) const {
+        return std::complex<T>(value.real(), -value.imag());
+    }
+};
+
+// |z| (or the Euclidean norm of a Vec) in lane 0
+class Magnitude {
+public:
+    // Whole frame: squares summed into lane 0, then one sqrt pass (see the note at the top)
+    template<typename T, std::size_t N, std::size_t K>
+    inline void applyLanes(std::array<std::array<T, N>, K>& lanes) const {
+        T* out = lanes[0].data();
+        for (reg i = 0; i < N; ++i) {
+            T sum = T(0);
+            for (reg k = 0; k < K; ++k) {
+                sum += lanes[k][i] * lanes[k][i];
+            }
+            out[i] = sum;
+        }
+        for (reg k = 1; k < K; ++k) {
+            lanes[k].fill(T(0));
+        }
+        soa_detail::sqrtInPlace<N>(out);
+    }
+
+    template<typename T>
+    inline std::complex<T> apply(std::complex<T> value) const {
+        return std::complex<T>(std::sqrt(value.real() * value.real() + value.imag() * value.imag()), T(0));
+    }
+
+    template<typename T, reg K>
+    inline Vec<T, K> apply(Vec<T, K> value) const {
+        T sum = T(0);
+        for (reg k = 0; k < K; ++k) {
+            sum += value.v[k] * value.v[k];
+        }
+        Vec<T, K> result;
+        result.v[0] = static_cast<T>(std::sqrt(sum));
+        return result;
+    }
+};
+
+// |z|^2 in lane 0, no square root
+class Power {
+public:
+    template<typename T>
+    inline constexpr std::complex<T> apply(std::complex<T> value) const {
+        return std::complex<T>(value.real() * value.real() + value.imag() * value.imag(), T(0));
+    }
+};
+
+// arg(z) in radians in lane 0, range [-pi, pi].
+// Polynomial atan2 (max error about 2e-6 rad) with blends instead of the
+// quadrant branches, so it vectorizes where std::atan2 would be a libm call.
+class Phase {
+public:
+    template<typename T>
+    inline std::complex<T> apply(std::complex<T> value) const {
+        const T x = value.real();
+        const T y = value.imag();
+        const T ax = std::fabs(x);
+        const T ay = std::fabs(y);
+
+        // atan(t) for t = min / max in [0, 1]
+        const bool steep = ay > ax;
+        const T high = blend(steep, ay, ax);
+        const T low = blend(steep, ax, ay);
+        const T t = low / blend(high == T(0), T(1), high);
+        const T s = t * t;
+        T angle = t * (T(0.99997726) + s * (T(-0.33262347) + s * (T(0.19354346) +
+                  s * (T(-0.11643287) + s * (T(0.05265332) + s * T(-0.01172120))))));
+
+        angle = blend(steep, T(HalfPi) - angle, angle);
+        angle = blend(x < T(0), T(Pi) - angle, angle);
+        angle = blend(y < T(0), -angle, angle);
+        return std::complex<T>(angle, T(0));
+    }
+
+private:
+    static constexpr f64 Pi = 3.14159265358979323846;
+    static constexpr f64 HalfPi = Pi / 2.0;
+};
+
+#endif /* ___MATH_TRANSFORM_SOA_TRANSFORM_H_ */
@@ -0,0 +1,18 @@
+# Command-line file streaming tool (no Qt dependency)
+TEMPLATE = app
+TARGET = stream_tool
+
+CONFIG += console c++17
+CONFIG -= qt app_bundle
+
+unix: LIBS += -lpthread
+
+SOURCES += \
+    stream_tool.cpp
+
+HEADERS += \
+    basic_types.h \
+    helpers.h \
+    Transform.h \
+    Span.h \
+    FileStream.h
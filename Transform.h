@@ -8,11 +8,22 @@
 #include <utility>
 #include <vector>
 #include "Span.h"
+#include "FlagMask.h"
 
 #if __cplusplus > 201703L
 #include <span>
 #endif /* __cplusplus > 201703L */
 
+// true while the enclosing function is evaluated at compile time:
+// lets constexpr code fall back from memcpy to plain loops
+#if __cplusplus > 201703L
+#define TRANSFORM_IS_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#elif defined(__GNUC__) || defined(__clang__) || (defined(_MSC_VER) && _MSC_VER >= 1925)
+#define TRANSFORM_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#else
+#define TRANSFORM_IS_CONSTANT_EVALUATED() false
+#endif
+
 // Template to check if type is std::array
 template <typename T>
 struct is_std_array : std::false_type {};
@@ -34,28 +45,158 @@ template <typename T>
 constexpr bool is_std_vector_v = is_std_vector<T>::value;
 
 
+// Template to check if a stage works on the whole buffer: applyBlock(ResultType* data, reg count)
+template <typename Stage, typename T, typename = void>
+struct is_block_stage : std::false_type {};
+
+template <typename Stage, typename T>
+struct is_block_stage<Stage, T, std::void_t<decltype(std::declval<Stage&>().applyBlock(std::declval<T*>(), std::declval<reg>()))>>
+    : std::true_type {};
+
+template <typename Stage, typename T>
+inline constexpr bool is_block_stage_v = is_block_stage<Stage, T>::value;
+
+
+// Template to check if a stage needs the element position: apply(ResultType value, reg index),
+// index counted from the start of the frame
+template <typename Stage, typename T, typename = void>
+struct is_indexed_stage : std::false_type {};
+
+template <typename Stage, typename T>
+struct is_indexed_stage<Stage, T, std::void_t<decltype(std::declval<Stage&>().apply(std::declval<T>(), std::declval<reg>()))>>
+    : std::true_type {};
+
+template <typename Stage, typename T>
+inline constexpr bool is_indexed_stage_v = is_indexed_stage<Stage, T>::value;
+
+
+// Template to check if a stage wants to know where a frame starts: beginFrame()
+template <typename Stage, typename = void>
+struct has_frame_hook : std::false_type {};
+
+template <typename Stage>
+struct has_frame_hook<Stage, std::void_t<decltype(std::declval<Stage&>().beginFrame())>> : std::true_type {};
+
+template <typename Stage>
+inline constexpr bool has_frame_hook_v = has_frame_hook<Stage>::value;
+
+
+// Template to check if a stage can run on several threads at once: apply() callable on a const stage
+template <typename Stage, typename T, typename = void>
+struct is_const_stage : std::false_type {};
+
+template <typename Stage, typename T>
+struct is_const_stage<Stage, T, std::void_t<decltype(std::declval<const Stage&>().apply(std::declval<T>()))>>
+    : std::true_type {};
+
+template <typename Stage, typename T>
+inline constexpr bool is_const_stage_v = is_const_stage<Stage, T>::value || is_indexed_stage_v<const Stage, T>;
+
+
+// stage.apply(value, index) for indexed stages, stage.apply(value) for the rest
+template<typename T, typename Stage>
+inline constexpr T applyAt(Stage& stage, T value, reg index) {
+    if constexpr (is_indexed_stage_v<Stage, T>) {
+        return static_cast<T>(stage.apply(value, index));
+    } else {
+        (void)index;
+        return static_cast<T>(stage.apply(value));
+    }
+}
+
+
+// How the stages are run over the buffer (picked by hand or by AutoTuner.h).
+// Threaded and Tiled are implemented in TransformParallel.h and need
+// attachParallel(); without it they run as PerStage.
+enum class ExecStrategy : u8 {
+    PerStage,   // one pass over the buffer per stage
+    Fused,      // one pass, all stages applied to each element in turn
+    Threaded,   // buffer split into chunks, run on a worker pool
+    Tiled       // cache-sized tiles, every stage over one tile before the next
+};
+
 // Break marker class
 class Break {
 public:
     Break() = default;
 };
 
+// Stage ranges around the first Break. Shared by Transform and by the classes
+// that run the same stage list their own way (ChannelBank, SoaTransform), so
+// the Break rules live in one place.
+template<typename... Transforms>
+struct StagePlan {
+private:
+    template<std::size_t... Indices>
+    static constexpr std::size_t findBreakIndex(std::index_sequence<Indices...>) {
+        constexpr std::array<bool, sizeof...(Transforms) + 1> isBreak = {
+            std::is_same_v<std::tuple_element_t<Indices, std::tuple<Transforms...>>, Break>..., false
+        };
+        for (std::size_t i = 0; i < sizeof...(Transforms); ++i) {
+            if (isBreak[i]) {
+                return i;
+            }
+        }
+        return sizeof...(Transforms);
+    }
+
+    template<std::size_t Offset, typename Function, std::size_t... Indices>
+    static constexpr void forEach(Function& function, std::index_sequence<Indices...>) {
+        (..., callStage<Offset + Indices>(function));
+    }
+
+    template<std::size_t Index, typename Function>
+    static constexpr void callStage(Function& function) {
+        if constexpr (!std::is_same_v<std::tuple_element_t<Index, std::tuple<Transforms...>>, Break>) {
+            function(std::integral_constant<std::size_t, Index>{});
+        }
+    }
+
+public:
+    static constexpr std::size_t Count = sizeof...(Transforms);
+    static constexpr std::size_t BreakIndex = findBreakIndex(std::make_index_sequence<Count>{});
+    static constexpr bool BreakExists = BreakIndex < Count;
+    static constexpr std::size_t BeforeBreakCount = BreakExists ? BreakIndex : 0;
+    static constexpr std::size_t AfterBreakCount = BreakExists ? Count - BreakIndex - 1 : 0;
+    static constexpr bool HasAfterBreak = AfterBreakCount > 0;
+
+    // Stages run by process(): the ones before Break, every stage without one
+    static constexpr std::size_t ProcessCount = BreakExists ? BreakIndex : Count;
+
+    // function(std::integral_constant<std::size_t, Index>) for every stage run by
+    // process(); later Break markers are skipped as well
+    template<typename Function>
+    static constexpr void forEachBeforeBreak(Function&& function) {
+        forEach<0>(function, std::make_index_sequence<ProcessCount>{});
+    }
+
+    // ... and for every stage left to results()
+    template<typename Function>
+    static constexpr void forEachAfterBreak(Function&& function) {
+        forEach<BreakIndex + 1>(function, std::make_index_sequence<AfterBreakCount>{});
+    }
+};
+
 // Main Transform class
 template<reg N, typename ResultType, bool UseFlags = true, typename... Transforms>
 class Transform {
     static_assert(N > 0, "N must be more than 0.");
-    static_assert(sizeof...(Transforms) <= 32, "Maximum number of transforms is limited to 32.");
     static_assert(std::is_arithmetic_v<ResultType>, "ResultType must be an arithmetic type.");
 
 public:
-    Transform() : m_transforms(), m_flags(0xFFFFFFFF), m_postBreakComputed(false) {}
+    // One flag per stage: a single word up to 32/64 stages, a multi-word mask above
+    using FlagsType = FlagMask<sizeof...(Transforms)>;
+    using Plan = StagePlan<Transforms...>;
+    using Stages = std::tuple<Transforms...>;
+
+    constexpr Transform() : m_transforms(), m_flags(), m_postBreakComputed(false) {}
 
-    explicit Transform(Transforms... transforms)
-        : m_transforms(std::forward<Transforms>(transforms)...), m_flags(0xFFFFFFFF), m_postBreakComputed(false) {}
+    explicit constexpr Transform(Transforms... transforms)
+        : m_transforms(std::forward<Transforms>(transforms)...), m_flags(), m_postBreakComputed(false) {}
 
     template<typename... TransformsArg>
     explicit constexpr Transform(std::tuple<TransformsArg...> transforms)
-        : m_transforms(std::move(transforms)), m_flags(0xFFFFFFFF), m_postBreakComputed(false) {}
+        : m_transforms(std::move(transforms)), m_flags(), m_postBreakComputed(false) {}
 
     template<std::size_t Index>
     inline constexpr auto& get() {
@@ -63,47 +204,146 @@ public:
         return std::get<Index>(m_transforms);
     }
 
+    // New pipeline with one more stage; this one is left unchanged (stages are copied)
     template<typename TransformType>
-    Transform<sizeof...(Transforms) + 1, ResultType, UseFlags, Transforms..., TransformType>
-    addTransform(TransformType&& transform) const {
-        static_assert(sizeof...(Transforms) < 32, "Cannot add more than 32 transformations.");
+    Transform<N, ResultType, UseFlags, Transforms..., std::decay_t<TransformType>>
+    addTransform(TransformType&& transform) const & {
+        return Transform<N, ResultType, UseFlags, Transforms..., std::decay_t<TransformType>>(
+            std::tuple_cat(m_transforms, std::tuple<std::decay_t<TransformType>>(std::forward<TransformType>(transform)))
+            );
+    }
 
-        return Transform<sizeof...(Transforms) + 1, ResultType, UseFlags, Transforms..., TransformType>(
-            std::tuple_cat(m_transforms, std::make_tuple(std::forward<TransformType>(transform)))
+    // Same on a temporary (builder chains, std::move): stages are moved, not copied
+    template<typename TransformType>
+    Transform<N, ResultType, UseFlags, Transforms..., std::decay_t<TransformType>>
+    addTransform(TransformType&& transform) && {
+        return Transform<N, ResultType, UseFlags, Transforms..., std::decay_t<TransformType>>(
+            std::tuple_cat(std::move(m_transforms), std::tuple<std::decay_t<TransformType>>(std::forward<TransformType>(transform)))
             );
     }
 
-    inline constexpr void setFlags(u32 flags) {
+    inline constexpr void setFlags(const FlagsType& flags) {
         if constexpr (UseFlags) {
             m_flags = flags;
             resetPostBreakFlag();
         }
     }
 
+    inline constexpr const FlagsType& flags() const {
+        return m_flags;
+    }
+
     inline constexpr bool ena(std::size_t index) {
         if constexpr (UseFlags) {
             if (index >= sizeof...(Transforms)) {
                 return false;
             }
-            m_flags |= (1U << index);
+            m_flags.set(index);
             resetPostBreakFlag();
         }
         return true;
     }
 
+    // Unsupported strategies (see supports()) fall back to PerStage
+    inline constexpr void setStrategy(ExecStrategy strategy) {
+        m_strategy = supports(strategy) ? strategy : ExecStrategy::PerStage;
+    }
+
+    inline constexpr ExecStrategy strategy() const {
+        return m_strategy;
+    }
+
+    // Fused and Threaded need element stages, Threaded also needs const apply().
+    // Tiled runs block stages over the whole buffer between tiled element stages.
+    static constexpr bool supports(ExecStrategy strategy) {
+        switch (strategy) {
+        case ExecStrategy::PerStage:
+        case ExecStrategy::Tiled:
+            return true;
+        case ExecStrategy::Fused:
+            return !HasBlockStages;
+        case ExecStrategy::Threaded:
+            return !HasBlockStages && ConstStages;
+        }
+        return false;
+    }
+
+    // Threads used by ExecStrategy::Threaded, 0 = the whole worker pool
+    inline constexpr void setThreads(reg threads) {
+        m_threads = threads;
+    }
+
+    inline constexpr reg threads() const {
+        return m_threads;
+    }
+
+    // Elements per tile for ExecStrategy::Tiled, 0 = sized from the L2 cache by TransformParallel.h
+    inline constexpr void setTileSize(reg elements) {
+        m_tile = elements;
+    }
+
+    inline constexpr reg tileSize() const {
+        return m_tile;
+    }
+
+    // Threaded / Tiled implementation, installed by attachParallel() (TransformParallel.h).
+    // Called with the stages of process() (afterBreak == false) or of results();
+    // data[0] is element first of the frame.
+    using ParallelRunner = void (*)(Transform& transform, ResultType* data, reg count, reg first, bool afterBreak);
+
+    inline constexpr void setParallelRunner(ParallelRunner runner, void* executor) {
+        m_runner = runner;
+        m_executor = executor;
+    }
+
+    inline constexpr void* parallelExecutor() const {
+        return m_executor;
+    }
+
     template<typename Input>
-    bool process(const Input& input) {
+    constexpr bool process(const Input& input) {
         resetPostBreakFlag();
 
+        if (!loadInput(input, m_results)) {
+            return false;
+        }
+        beginFrame();
+
+        if constexpr (UseFlags) {
+            if (m_flags.none()) return true;
+        }
+
+        applyBeforeBreak(m_results.data(), N);
+        return true;
+    }
+
+    // The whole pipeline (process() + results()) in place over data[0, count),
+    // without copying the frame in and out of the Transform; results() is not
+    // changed. The data is one frame (count <= N), except for FrameIndependent
+    // pipelines, which take any number of elements at once.
+    inline constexpr void apply(ResultType* data, reg count) {
+        beginFrame();
+
+        if constexpr (UseFlags) {
+            if (m_flags.none()) return;
+        }
+
+        applyBeforeBreak(data, count);
+        applyAfterBreak(data, count);
+    }
+
+    // Copies/converts any supported input into dst, false if it is too small or unsupported
+    template<typename Input>
+    static constexpr bool loadInput(const Input& input, std::array<ResultType, N>& dst) {
         // check array or vector if is the same type
         if constexpr (std::is_same_v<Input, std::array<ResultType, N>>) {
-            m_results = input;
+            dst = input;
         } else if constexpr (std::is_same_v<Input, std::vector<ResultType>>) {
             if (input.size() < N) {
                 return false;
             }
 
-            std::memcpy(m_results.data(), input.data(), N * sizeof(ResultType));
+            copyInput(dst, input.data());
         }
 
         // check if is array or vector
@@ -113,7 +353,7 @@ public:
             }
 
             for (reg i = 0; i < N; ++i) {
-                m_results[i] = static_cast<ResultType>(input[i]);
+                dst[i] = static_cast<ResultType>(input[i]);
             }
         } else if constexpr (std::is_array_v<Input> && std::is_same_v<std::remove_extent_t<Input>, ResultType>) {
             if constexpr (std::extent_v<Input> < N) { // Checking the array size
@@ -121,7 +361,7 @@ public:
             }
 
             // Using std::data to get a pointer to the beginning of the array
-            std::memcpy(m_results.data(), std::data(input), N * sizeof(ResultType));
+            copyInput(dst, std::data(input));
 
         } else if constexpr (std::is_array_v<Input>) {
             if constexpr (std::extent_v<Input> < N) { // Checking the array size
@@ -129,7 +369,7 @@ public:
             }
 
             for (reg i = 0; i < N; ++i) {
-                m_results[i] = static_cast<ResultType>(input[i]);
+                dst[i] = static_cast<ResultType>(input[i]);
             }
         }
 
@@ -139,14 +379,14 @@ public:
                 return false;
             }
 
-            std::memcpy(m_results.data(), input.data(), N * sizeof(ResultType));
+            copyInput(dst, input.data());
         } else if constexpr (std::is_same_v<Input, Span<typename Input::value_type>>) {
             if (input.size() < N) {
                 return false;
             }
 
             for (reg i = 0; i < N; ++i) {
-                m_results[i] = static_cast<ResultType>(input[i]);
+                dst[i] = static_cast<ResultType>(input[i]);
             }
         }
 
@@ -156,14 +396,14 @@ public:
                 return false;
             }
 
-            std::memcpy(m_results.data(), input.data(), N * sizeof(ResultType));
+            copyInput(dst, input.data());
 
         } else if constexpr (std::is_same_v<Input, std::span<typename Input::value_type>>) {
             if (input.size() < N) {
                 return false;
             }
             for (reg i = 0; i < N; ++i) {
-                m_results[i] = static_cast<ResultType>(input[i]);
+                dst[i] = static_cast<ResultType>(input[i]);
             }
         }
 #endif /* __cplusplus > 201703L */
@@ -172,134 +412,298 @@ public:
             return false;
         }
 
-        if constexpr (UseFlags) {
-            if (m_flags == 0) return true;
+        return true;
+    }
+
+    // Starts a new frame for the stages that keep per-frame state (beginFrame()).
+    // process() calls it; code that drives applyBeforeBreak() itself calls it once per frame.
+    inline constexpr void beginFrame() {
+        if constexpr (HasFrameHooks) {
+            beginFrameStages(std::make_index_sequence<sizeof...(Transforms)>{});
         }
+    }
+
+    // Pre-Break stages (all stages without Break) over an arbitrary element range,
+    // data[0] being element first of the frame (the index indexed stages see).
+    // Block stages see only this range, so partial ranges need HasBlockStages == false.
+    inline constexpr void applyBeforeBreak(ResultType* data, reg count, reg first = 0) {
+        run<0>(data, count, first, std::make_index_sequence<Plan::ProcessCount>{});
+    }
 
+    // Post-Break stages over an arbitrary element range
+    inline constexpr void applyAfterBreak(ResultType* data, reg count, reg first = 0) {
         if constexpr (BreakExists) {
-            if constexpr (BreakIndex > 0 && BreakIndex < sizeof...(Transforms) - 1) {
-                applyTransformsBeforeBreak(std::make_index_sequence<BeforeBreakCount>{});
-            } else if constexpr (BreakIndex == sizeof...(Transforms) - 1) {
-                applyTransforms(std::make_index_sequence<sizeof...(Transforms)>{});
-            }
-        } else {
-            applyTransforms(std::make_index_sequence<sizeof...(Transforms)>{});
+            run<BreakIndex + 1>(data, count, first, std::make_index_sequence<AfterBreakCount>{});
         }
+    }
 
-        return true;
+    // Enabled stages in [Begin, End) over an element range, one pass per stage
+    // (the building block of the strategies in TransformParallel.h)
+    template<std::size_t Begin, std::size_t End>
+    inline constexpr void applyStages(ResultType* data, reg count, reg first = 0) {
+        applyTransforms<Begin>(data, count, first, std::make_index_sequence<End - Begin>{});
     }
 
+    // Only the ranges not already computed by results(offset, count) are evaluated
     inline constexpr std::array<ResultType, N>& results() {
-        if constexpr (BreakExists && BreakIndex < sizeof...(Transforms) - 1) {
+        if constexpr (HasAfterBreak) {
             if (!m_postBreakComputed) {
-                applyTransformsAfterBreak(std::make_index_sequence<AfterBreakCount>{});
-                m_postBreakComputed = true;
+                computeChunks(0, ChunkCount);
             }
         }
         return m_results;
     }
 
+    // Post-Break stages over [offset, offset + count) only (rounded out to whole
+    // chunks of RangeChunk elements). Computed chunks are remembered until the
+    // next process(), so overlapping requests and a later results() do not
+    // compute them again. The whole frame is computed, in order, when a
+    // post-Break stage cannot run on parts (see RangedStages).
+    inline constexpr Span<ResultType> results(reg offset, reg count) {
+        if (offset >= N) {
+            return Span<ResultType>();
+        }
+        if (count > N - offset) {
+            count = N - offset;
+        }
+
+        if constexpr (HasAfterBreak) {
+            if (!m_postBreakComputed) {
+                if constexpr (!RangedStages) {
+                    results();
+                } else {
+                    computeChunks(offset / RangeChunk, (offset + count + RangeChunk - 1) / RangeChunk);
+                }
+            }
+        }
+        return Span<ResultType>(m_results.data() + offset, count);
+    }
+
     inline constexpr std::array<ResultType, N>& get_array() {
         return m_results;
     }
 
 private:
-    static constexpr std::size_t findBreakIndex() {
-        return findBreakIndexImpl(std::make_index_sequence<sizeof...(Transforms)>{});
+    // memcpy at run time, an element loop in constant expressions
+    static constexpr void copyInput(std::array<ResultType, N>& dst, const ResultType* src) {
+        if (!TRANSFORM_IS_CONSTANT_EVALUATED()) {
+            std::memcpy(dst.data(), src, N * sizeof(ResultType));
+            return;
+        }
+        for (reg i = 0; i < N; ++i) {
+            dst[i] = src[i];
+        }
     }
 
     template<std::size_t... Indices>
-    static constexpr std::size_t findBreakIndexImpl(std::index_sequence<Indices...>) {
-        constexpr std::array<bool, sizeof...(Transforms)> isBreak = {
-            std::is_same_v<std::tuple_element_t<Indices, std::tuple<Transforms...>>, Break>...
-        };
+    inline constexpr void beginFrameStages(std::index_sequence<Indices...>) {
+        (..., beginFrameStage<Indices>());
+    }
 
-        // Find the first index where isBreak[i] == true
-        for (std::size_t i = 0; i < isBreak.size(); ++i) {
-            if (isBreak[i]) {
-                return i;
-            }
+    template<std::size_t Index>
+    inline constexpr void beginFrameStage() {
+        if constexpr (has_frame_hook_v<std::tuple_element_t<Index, std::tuple<Transforms...>>>) {
+            std::get<Index>(m_transforms).beginFrame();
         }
+    }
 
-        // If Break is not found
-        return sizeof...(Transforms);
+    // Runs stages [Offset, Offset + sizeof...(Indices)) with the selected strategy
+    template<std::size_t Offset, std::size_t... Indices>
+    inline constexpr void run(ResultType* data, reg count, reg first, std::index_sequence<Indices...> stages) {
+        if (m_strategy == ExecStrategy::Threaded || m_strategy == ExecStrategy::Tiled) {
+            if (m_runner != nullptr) {
+                m_runner(*this, data, count, first, Offset != 0);
+                return;
+            }
+        }
+        if constexpr (!HasBlockStages) {
+            if (m_strategy == ExecStrategy::Fused) {
+                applyFused<Offset>(data, count, first, stages);
+                return;
+            }
+        }
+        applyTransforms<Offset>(data, count, first, stages);
     }
 
-private:
-    template<std::size_t... Indices>
-    inline constexpr void applyTransforms(std::index_sequence<Indices...>) {
-        if constexpr (UseFlags) {
-            (..., (shouldApply<Indices>() ? applyTransform<Indices>() : void()));
-        } else {
-            (..., applyTransform<Indices>());
+    template<std::size_t Offset, std::size_t... Indices>
+    inline constexpr void applyFused(ResultType* data, reg count, reg first, std::index_sequence<Indices...>) {
+        [[maybe_unused]] const std::array<bool, sizeof...(Indices)> active = {shouldApply<Offset + Indices>()...};
+        for (reg i = 0; i < count; ++i) {
+            ResultType value = data[i];
+            (..., (active[Indices] ? void(value = applyElement<Offset + Indices>(value, first + i)) : void()));
+            data[i] = value;
         }
     }
 
-    template<std::size_t... Indices>
-    inline constexpr void applyTransformsBeforeBreak(std::index_sequence<Indices...>) {
-        if constexpr (UseFlags) {
-            (..., (shouldApply<Indices>() ? applyTransform<Indices>() : void()));
+    template<std::size_t Index>
+    inline constexpr ResultType applyElement(ResultType value, [[maybe_unused]] reg index) {
+        using TransformType = std::tuple_element_t<Index, std::tuple<Transforms...>>;
+
+        if constexpr (std::is_same_v<TransformType, Break>) {
+            return value;
         } else {
-            (..., applyTransform<Indices>());
+            return applyAt(std::get<Index>(m_transforms), value, index);
         }
     }
 
-    template<std::size_t... Indices>
-    inline constexpr void applyTransformsAfterBreak(std::index_sequence<Indices...>) {
+    template<std::size_t Offset, std::size_t... Indices>
+    inline constexpr void applyTransforms(ResultType* data, reg count, reg first, std::index_sequence<Indices...>) {
         if constexpr (UseFlags) {
-            (..., (shouldApply<BreakIndex + 1 + Indices>() ? applyTransform<BreakIndex + 1 + Indices>() : void()));
+            (..., (shouldApply<Offset + Indices>() ? applyTransform<Offset + Indices>(data, count, first) : void()));
         } else {
-            (..., applyTransform<BreakIndex + 1 + Indices>());
+            (..., applyTransform<Offset + Indices>(data, count, first));
         }
     }
 
     template<std::size_t Index>
     inline constexpr bool shouldApply() const {
         if constexpr (UseFlags) {
-            return (m_flags & (1U << Index)) != 0;
+            return m_flags.template test<Index>();
         } else {
             return true;
         }
     }
 
     template<std::size_t Index>
-    inline constexpr void applyTransform() {
+    inline constexpr void applyTransform(ResultType* data, reg count, [[maybe_unused]] reg first) {
         using TransformType = std::tuple_element_t<Index, std::tuple<Transforms...>>;
 
         if constexpr (std::is_same_v<TransformType, Break>) {
             return;
+        } else if constexpr (is_block_stage_v<TransformType, ResultType>) {
+            std::get<Index>(m_transforms).applyBlock(data, count);
+        } else if constexpr (is_indexed_stage_v<TransformType, ResultType>) {
+            auto& transform = std::get<Index>(m_transforms);
+            for (reg i = 0; i < count; ++i) {
+                data[i] = static_cast<ResultType>(transform.apply(data[i], first + i));
+            }
         } else {
             auto& transform = std::get<Index>(m_transforms);
-            if constexpr (N == 1) {
-                m_results[0] = static_cast<ResultType>(transform.apply(m_results[0]));
-            } else {
-                for (auto& value : m_results) {
-                    value = static_cast<ResultType>(transform.apply(value));
-                }
+            for (reg i = 0; i < count; ++i) {
+                data[i] = static_cast<ResultType>(transform.apply(data[i]));
             }
         }
     }
 
     inline constexpr void resetPostBreakFlag() {
-        if constexpr (BreakExists && BreakIndex > 0 && BreakIndex < sizeof...(Transforms) - 1) {
+        if constexpr (HasAfterBreak) {
             m_postBreakComputed = false;
+            if (m_computedChunks != 0) {
+                for (u64& word : m_chunks) {
+                    word = 0; // std::array::fill is not constexpr in C++17
+                }
+                m_computedChunks = 0;
+            }
         }
     }
 
+    // Runs the post-Break stages over every not yet computed chunk in [first, last)
+    inline constexpr void computeChunks(reg first, reg last) {
+        reg chunk = first;
+        while (chunk < last) {
+            if (chunkComputed(chunk)) {
+                ++chunk;
+                continue;
+            }
+
+            // One pass over the whole run of missing chunks
+            const reg runBegin = chunk;
+            while (chunk < last && !chunkComputed(chunk)) {
+                m_chunks[chunk / 64] |= u64(1) << (chunk % 64);
+                ++chunk;
+            }
+            const reg begin = runBegin * RangeChunk;
+            const reg end = (chunk * RangeChunk < N) ? chunk * RangeChunk : N;
+            applyAfterBreak(m_results.data() + begin, end - begin, begin);
+            m_computedChunks += chunk - runBegin;
+        }
+
+        if (m_computedChunks == ChunkCount) {
+            m_postBreakComputed = true;
+        }
+    }
+
+    inline constexpr bool chunkComputed(reg chunk) const {
+        return (m_chunks[chunk / 64] >> (chunk % 64)) & 1U;
+    }
+
 public:
     static constexpr std::size_t TransformSize = sizeof...(Transforms);
     static constexpr std::size_t DataSize = N;
-    static constexpr std::size_t BreakIndex = findBreakIndex();
-    static constexpr bool BreakExists = BreakIndex < sizeof...(Transforms);
-    static constexpr std::size_t BeforeBreakCount = BreakExists ? BreakIndex : 0;
-    static constexpr std::size_t AfterBreakCount = BreakExists ? sizeof...(Transforms) - BreakIndex - 1 : 0;
+    static constexpr std::size_t BreakIndex = Plan::BreakIndex;
+    static constexpr bool BreakExists = Plan::BreakExists;
+    static constexpr std::size_t BeforeBreakCount = Plan::BeforeBreakCount;
+    static constexpr std::size_t AfterBreakCount = Plan::AfterBreakCount;
+    static constexpr bool HasBlockStages = (false || ... || is_block_stage_v<Transforms, ResultType>);
+    static constexpr bool HasAfterBreak = Plan::HasAfterBreak;
+    static constexpr reg RangeChunk = 256;  // granularity of results(offset, count)
+    static constexpr reg ChunkCount = (N + RangeChunk - 1) / RangeChunk;
+    static constexpr bool ConstStages = (true && ... && (std::is_same_v<Transforms, Break> || is_const_stage_v<Transforms, ResultType>));
+    static constexpr bool HasIndexedStages = (false || ... || is_indexed_stage_v<Transforms, ResultType>);
+    static constexpr bool HasFrameHooks = (false || ... || has_frame_hook_v<Transforms>);
+
+    // Only element stages that ignore frame boundaries: apply() may run over many frames at once
+    static constexpr bool FrameIndependent = !HasBlockStages && !HasIndexedStages && !HasFrameHooks;
+
+private:
+    // A post-Break stage may run on parts of the frame in any order if it is a
+    // const element stage, or an indexed one (it places values by index).
+    // Other non-const stages are assumed to carry state from element to element.
+    template<std::size_t... Indices>
+    static constexpr bool rangedStages(std::index_sequence<Indices...>) {
+        return (true && ... && rangedStage<std::tuple_element_t<Plan::BreakIndex + 1 + Indices, Stages>>());
+    }
+
+    template<typename Stage>
+    static constexpr bool rangedStage() {
+        return std::is_same_v<Stage, Break> || is_indexed_stage_v<Stage, ResultType> ||
+               (!is_block_stage_v<Stage, ResultType> && is_const_stage_v<Stage, ResultType>);
+    }
+
+public:
+    // results(offset, count) computes only the requested chunks
+    static constexpr bool RangedStages = rangedStages(std::make_index_sequence<Plan::AfterBreakCount>{});
 
 private:
     std::array<ResultType, N> m_results = {};
     std::tuple<Transforms...> m_transforms;
-    u32 m_flags = 0xFFFFFFFF;
+    FlagsType m_flags = {};
+    ExecStrategy m_strategy = ExecStrategy::PerStage;
+    reg m_threads = 0;
+    reg m_tile = 0;
+    ParallelRunner m_runner = nullptr;
+    void* m_executor = nullptr;
+    std::array<u64, HasAfterBreak ? (ChunkCount + 63) / 64 : 0> m_chunks = {};  // computed post-Break chunks
+    reg m_computedChunks = 0;
     bool m_postBreakComputed = false;
 };
 
+// Runs a whole input table through the pipeline, N elements per frame.
+// With constexpr stages it can be evaluated at compile time:
+//
+//     constexpr auto curve = bakeTable(Transform<4, float, false, Multiply, Add>(Multiply(2.0f), Add(1.0f)),
+//                                      std::array<float, 8>{0, 1, 2, 3, 4, 5, 6, 7});
+template<reg N, typename ResultType, bool UseFlags, typename... Transforms, typename T, std::size_t Size>
+constexpr std::array<ResultType, Size> bakeTable(Transform<N, ResultType, UseFlags, Transforms...> transform,
+                                                 const std::array<T, Size>& table) {
+    static_assert(Size % N == 0, "Table size must be a multiple of N.");
+
+    std::array<ResultType, Size> baked = {};
+    std::array<ResultType, N> frame = {};
+
+    for (reg begin = 0; begin < Size; begin += N) {
+        for (reg i = 0; i < N; ++i) {
+            frame[i] = static_cast<ResultType>(table[begin + i]);
+        }
+
+        transform.process(frame);
+        const std::array<ResultType, N>& results = transform.results();
+        for (reg i = 0; i < N; ++i) {
+            baked[begin + i] = results[i];
+        }
+    }
+    return baked;
+}
+
 #endif /* ___MATH_TRANSFORM_TRANSFORM_H_ */
 
@@ -4,6 +4,16 @@ greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 CONFIG += c++17
 
+# Optional C++20 coroutine API (AsyncTransform.h): qmake CONFIG+=transform_coroutines
+transform_coroutines {
+    CONFIG -= c++17
+    CONFIG += c++20
+    DEFINES += TRANSFORM_COROUTINES
+}
+
+# shm_open (SharedRing.h) lives in librt on older glibc
+unix:!macx: LIBS += -lrt
+
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
@@ -13,7 +23,8 @@ SOURCES += \
     mainwindow.cpp\
     Transform.cpp \
     test.cpp\
-    Span.cpp
+    Span.cpp \
+    envelopeview.cpp
 
 HEADERS += \
     helpers.h \
@@ -21,7 +32,27 @@ HEADERS += \
     basic_types.h\
     Transform.h \
     test.h\
-     Span.h
+     Span.h \
+    ChannelBank.h \
+    HotSwap.h \
+    AsyncTransform.h \
+    Decimate.h \
+    envelopeview.h \
+    TransformTree.h \
+    FlagMask.h \
+    DeltaTransform.h \
+    WindowedTransform.h \
+    BlockStages.h \
+    AutoTuner.h \
+    CacheInfo.h \
+    Quantize.h \
+    Predicates.h \
+    SnapshotTransform.h \
+    SharedRing.h \
+    SoaTransform.h \
+    Scheduler.h \
+    SharedState.h \
+    TransformParallel.h
 
 FORMS += \
     mainwindow.ui
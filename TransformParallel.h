@@ -0,0 +1,296 @@
+/*
+ * TransformParallel.h
+ *
+ * The Threaded and Tiled execution strategies. They live outside Transform.h
+ * because they need threads and the cache size of the host (CacheInfo.h);
+ * pipelines that never use them do not pay for either.
+ *
+ *     WorkerPool pool(4);                       // persistent threads, shared by any number of pipelines
+ *     attachParallel(transform, pool);          // or attachParallel(transform): WorkerPool::shared()
+ *     transform.setStrategy(ExecStrategy::Threaded);
+ *
+ * Threaded splits the frame into cache-line aligned chunks and runs them on
+ * the pool; the calling thread takes chunks too. The pool threads are started
+ * once and sleep between frames, so a process() call costs a wake-up, not a
+ * thread start. One frame runs on a pool at a time: pipelines sharing a pool
+ * from several threads take turns.
+ *
+ * Tiled runs the element stages tile by tile (tileSize() elements, by default
+ * half of the L2 cache) so that every stage finds the tile still in cache. A
+ * block stage ends a tiled segment and runs over the whole buffer.
+ */
+
+#ifndef ___MATH_TRANSFORM_PARALLEL_H_
+#define ___MATH_TRANSFORM_PARALLEL_H_
+
+#include "Transform.h"
+#include "CacheInfo.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent fork-join pool: parallelFor() runs tasks 0..count-1 on the pool
+// threads and the caller, and returns when all of them are done
+class WorkerPool {
+public:
+    // threads == 0: one per hardware thread (the caller counts as one)
+    explicit WorkerPool(reg threads = 0) {
+        if (threads == 0) {
+            threads = static_cast<reg>(std::thread::hardware_concurrency());
+        }
+        threads = threads != 0 ? threads : 1;
+
+        m_threads.reserve(threads - 1);
+        for (reg i = 0; i + 1 < threads; ++i) {
+            m_threads.emplace_back([this]() { workerLoop(); });
+        }
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (std::thread& thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    // Pool used by attachParallel() without an explicit pool, started on first use
+    static WorkerPool& shared() {
+        static WorkerPool pool;
+        return pool;
+    }
+
+    // Threads that take tasks, the caller included
+    inline reg size() const { return m_threads.size() + 1; }
+
+    template<typename Function>
+    void parallelFor(reg count, Function&& function) {
+        if (count == 0) {
+            return;
+        }
+        if (count == 1 || m_threads.empty()) {
+            for (reg i = 0; i < count; ++i) {
+                function(i);
+            }
+            return;
+        }
+
+        std::lock_guard<std::mutex> serial(m_callMutex);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_task = &call<std::remove_reference_t<Function>>;
+            m_context = &function;
+            m_count = count;
+            m_next.store(0, std::memory_order_relaxed);
+            m_remaining = count;
+            ++m_generation;
+        }
+        m_wake.notify_all();
+
+        work(m_task, m_context, count);
+
+        // Done when every task ran and no pool thread still holds this job
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this]() { return m_remaining == 0 && m_active == 0; });
+        m_task = nullptr;
+    }
+
+private:
+    using Task = void (*)(void*, reg);
+
+    template<typename Function>
+    static void call(void* context, reg index) {
+        (*static_cast<Function*>(context))(index);
+    }
+
+    void work(Task task, void* context, reg count) {
+        reg finished = 0;
+        for (reg index = m_next.fetch_add(1, std::memory_order_relaxed); index < count;
+             index = m_next.fetch_add(1, std::memory_order_relaxed)) {
+            task(context, index);
+            ++finished;
+        }
+        if (finished != 0) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_remaining -= finished;
+            if (m_remaining == 0) {
+                m_done.notify_one();
+            }
+        }
+    }
+
+    void workerLoop() {
+        u64 seen = 0;
+        for (;;) {
+            Task task = nullptr;
+            void* context = nullptr;
+            reg count = 0;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [&]() { return m_stop || (m_generation != seen && m_task != nullptr); });
+                if (m_stop) {
+                    return;
+                }
+                seen = m_generation;
+                task = m_task;
+                context = m_context;
+                count = m_count;
+                ++m_active;
+            }
+
+            work(task, context, count);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_active == 0 && m_remaining == 0) {
+                m_done.notify_one();
+            }
+        }
+    }
+
+private:
+    std::vector<std::thread> m_threads;
+    std::mutex m_callMutex;             // one parallelFor at a time
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    Task m_task = nullptr;              // current job, nullptr once it is finished
+    void* m_context = nullptr;
+    reg m_count = 0;
+    std::atomic<reg> m_next{0};
+    reg m_remaining = 0;                // tasks not finished yet
+    reg m_active = 0;                   // pool threads inside the current job
+    u64 m_generation = 0;
+    bool m_stop = false;
+};
+
+namespace parallel_detail {
+
+template<typename ResultType>
+inline constexpr reg LineElements = 64 / sizeof(ResultType) > 0 ? 64 / sizeof(ResultType) : 1;
+
+template<typename Stages, typename ResultType, std::size_t... Indices>
+constexpr std::size_t nextBlockStage(std::size_t begin, std::size_t end, std::index_sequence<Indices...>) {
+    constexpr std::array<bool, sizeof...(Indices) + 1> isBlock = {
+        is_block_stage_v<std::tuple_element_t<Indices, Stages>, ResultType>..., false
+    };
+    for (std::size_t i = begin; i < end; ++i) {
+        if (isBlock[i]) {
+            return i;
+        }
+    }
+    return end;
+}
+
+template<typename ResultType, typename Engine>
+inline reg tileElements(const Engine& transform) {
+    constexpr reg Line = LineElements<ResultType>;
+
+    if (transform.tileSize() != 0) {
+        return transform.tileSize();
+    }
+    const reg elements = defaultTileBytes() / sizeof(ResultType);
+    return elements > Line ? elements / Line * Line : Line;
+}
+
+// Element stages in [Begin, End) run tile by tile; a block stage ends the
+// segment and runs over the whole buffer, then tiling resumes after it
+template<std::size_t Begin, std::size_t End, typename Engine, typename ResultType>
+void runTiled(Engine& transform, ResultType* data, reg count, reg first) {
+    if constexpr (Begin < End) {
+        constexpr std::size_t Block = nextBlockStage<typename Engine::Stages, ResultType>(
+            Begin, End, std::make_index_sequence<Engine::TransformSize>{});
+
+        if constexpr (Block > Begin) {
+            const reg tile = tileElements<ResultType>(transform);
+            for (reg begin = 0; begin < count; begin += tile) {
+                const reg size = (count - begin < tile) ? count - begin : tile;
+                transform.template applyStages<Begin, Block>(data + begin, size, first + begin);
+            }
+        }
+
+        if constexpr (Block < End) {
+            transform.template applyStages<Block, Block + 1>(data, count, first);
+            runTiled<Block + 1, End>(transform, data, count, first);
+        }
+    }
+}
+
+template<std::size_t Begin, std::size_t End, typename Engine, typename ResultType>
+void runThreaded(Engine& transform, ResultType* data, reg count, reg first) {
+    constexpr reg MinChunk = 4096; // smaller chunks do not pay for the wake-up
+    constexpr reg Line = LineElements<ResultType>;
+
+    WorkerPool& pool = *static_cast<WorkerPool*>(transform.parallelExecutor());
+    reg threads = transform.threads() != 0 && transform.threads() < pool.size() ? transform.threads() : pool.size();
+    if (threads > count / MinChunk) {
+        threads = count / MinChunk;
+    }
+    if (threads < 2) {
+        transform.template applyStages<Begin, End>(data, count, first);
+        return;
+    }
+
+    // Chunks are whole cache lines so that threads never write the same line
+    reg chunk = (count + threads - 1) / threads;
+    chunk = (chunk + Line - 1) / Line * Line;
+    const reg chunks = (count + chunk - 1) / chunk;
+
+    // Threaded requires const element stages (see Transform::supports), so
+    // the chunks may run the same stage objects concurrently
+    pool.parallelFor(chunks, [&transform, data, count, first, chunk](reg index) {
+        const reg begin = index * chunk;
+        const reg size = (count - begin < chunk) ? count - begin : chunk;
+        transform.template applyStages<Begin, End>(data + begin, size, first + begin);
+    });
+}
+
+template<std::size_t Begin, std::size_t End, typename Engine, typename ResultType>
+void runRange(Engine& transform, ResultType* data, reg count, reg first) {
+    if (transform.strategy() == ExecStrategy::Tiled) {
+        runTiled<Begin, End>(transform, data, count, first);
+    } else if constexpr (Engine::supports(ExecStrategy::Threaded)) {
+        runThreaded<Begin, End>(transform, data, count, first);
+    } else {
+        transform.template applyStages<Begin, End>(data, count, first);
+    }
+}
+
+template<typename Engine, typename ResultType>
+void runner(Engine& transform, ResultType* data, reg count, reg first, bool afterBreak) {
+    using Plan = typename Engine::Plan;
+    if (afterBreak) {
+        if constexpr (Plan::BreakExists) {
+            runRange<Plan::BreakIndex + 1, Plan::Count>(transform, data, count, first);
+        }
+    } else {
+        runRange<0, Plan::ProcessCount>(transform, data, count, first);
+    }
+}
+
+} // namespace parallel_detail
+
+// Lets transform use ExecStrategy::Threaded (on pool) and ExecStrategy::Tiled.
+// The pool must outlive the transform and its copies.
+template<reg N, typename ResultType, bool UseFlags, typename... Transforms>
+inline void attachParallel(Transform<N, ResultType, UseFlags, Transforms...>& transform, WorkerPool& pool = WorkerPool::shared()) {
+    using Engine = Transform<N, ResultType, UseFlags, Transforms...>;
+    transform.setParallelRunner(&parallel_detail::runner<Engine, ResultType>, &pool);
+}
+
+// Tile size Tiled uses for this transform: tileSize(), or half of L2 if it is 0
+template<reg N, typename ResultType, bool UseFlags, typename... Transforms>
+inline reg effectiveTileSize(const Transform<N, ResultType, UseFlags, Transforms...>& transform) {
+    return parallel_detail::tileElements<ResultType>(transform);
+}
+
+#endif /* ___MATH_TRANSFORM_PARALLEL_H_ */
@@ -0,0 +1,170 @@
+/*
+ * TransformTree.h
+ *
+ * Branching pipeline: stages form a tree, every leaf is an output.
+ *
+ *     auto tree = makeTree<N, float>(
+ *         Node(Chain(Multiply(2.0f), Add(1.0f)),   // shared prefix
+ *              Node(Chain()),                      // output 0: calibrated
+ *              Node(Chain(Sqrt())),                // output 1: calibrated + sqrt
+ *              Node(Chain(Multiply(0.5f)))));      // output 2: scaled for DAC
+ *     tree.process(input);
+ *     tree.output<1>();
+ *
+ * process() makes a single fused pass over the input: each element runs
+ * through every stage of the tree exactly once (the shared prefix is not
+ * recomputed per output) and each leaf stores its value into its own output
+ * buffer. The input is read in place, no copy is made.
+ *
+ * Leaves are numbered depth-first, left to right.
+ */
+
+#ifndef ___MATH_TRANSFORM_TRANSFORM_TREE_H_
+#define ___MATH_TRANSFORM_TRANSFORM_TREE_H_
+
+#include "Transform.h"
+
+// Linear sequence of stages inside one tree node
+template<typename... Stages>
+class Chain {
+public:
+    Chain() = default;
+
+    template<std::size_t Count = sizeof...(Stages), typename = std::enable_if_t<(Count > 0)>>
+    explicit Chain(Stages... stages) : m_stages(std::move(stages)...) {}
+
+    template<std::size_t Index>
+    inline constexpr auto& get() {
+        static_assert(Index < sizeof...(Stages), "Index out of bounds.");
+        return std::get<Index>(m_stages);
+    }
+
+    template<typename ResultType>
+    inline constexpr ResultType apply(ResultType value) {
+        return applyImpl(value, std::make_index_sequence<sizeof...(Stages)>{});
+    }
+
+private:
+    template<typename ResultType, std::size_t... Indices>
+    inline constexpr ResultType applyImpl(ResultType value, std::index_sequence<Indices...>) {
+        (..., (value = static_cast<ResultType>(std::get<Indices>(m_stages).apply(value))));
+        return value;
+    }
+
+private:
+    std::tuple<Stages...> m_stages;
+};
+
+template<typename... Stages>
+Chain(Stages...) -> Chain<Stages...>;
+
+// Chain followed by a fan-out into child nodes; a node without children is a leaf
+template<typename ChainType, typename... Children>
+class Node {
+public:
+    Node() = default;
+    explicit Node(ChainType chain, Children... children) : m_chain(std::move(chain)), m_children(std::move(children)...) {}
+
+    inline constexpr ChainType& chain() { return m_chain; }
+
+    template<std::size_t Index>
+    inline constexpr auto& child() {
+        static_assert(Index < sizeof...(Children), "Index out of bounds.");
+        return std::get<Index>(m_children);
+    }
+
+    static constexpr std::size_t Leaves = (sizeof...(Children) == 0) ? 1 : (0 + ... + Children::Leaves);
+
+    // Runs one element through this subtree, Offset is the index of its first leaf
+    template<std::size_t Offset, typename ResultType, typename Outputs>
+    inline constexpr void run(ResultType value, Outputs& outputs, reg index) {
+        value = m_chain.apply(value);
+
+        if constexpr (sizeof...(Children) == 0) {
+            outputs[Offset][index] = value;
+        } else {
+            runChildren<Offset>(value, outputs, index, std::make_index_sequence<sizeof...(Children)>{});
+        }
+    }
+
+private:
+    template<std::size_t Child>
+    static constexpr std::size_t leafOffset() {
+        constexpr std::array<std::size_t, sizeof...(Children) + 1> leaves = {Children::Leaves..., 0};
+        std::size_t offset = 0;
+        for (std::size_t i = 0; i < Child; ++i) {
+            offset += leaves[i];
+        }
+        return offset;
+    }
+
+    template<std::size_t Offset, typename ResultType, typename Outputs, std::size_t... Indices>
+    inline constexpr void runChildren(ResultType value, Outputs& outputs, reg index, std::index_sequence<Indices...>) {
+        (..., std::get<Indices>(m_children).template run<Offset + leafOffset<Indices>()>(value, outputs, index));
+    }
+
+private:
+    ChainType m_chain;
+    std::tuple<Children...> m_children;
+};
+
+template<typename ChainType, typename... Children>
+Node(ChainType, Children...) -> Node<ChainType, Children...>;
+
+// Main TransformTree class
+template<reg N, typename ResultType, typename Root>
+class TransformTree {
+    static_assert(N > 0, "N must be more than 0.");
+    static_assert(std::is_arithmetic_v<ResultType>, "ResultType must be an arithmetic type.");
+
+public:
+    static constexpr std::size_t OutputCount = Root::Leaves;
+    static constexpr std::size_t DataSize = N;
+
+    TransformTree() = default;
+    explicit TransformTree(Root root) : m_root(std::move(root)) {}
+
+    inline constexpr Root& root() { return m_root; }
+
+    // Accepts std::array, std::vector, Span (any element type) and C arrays
+    template<typename Input>
+    bool process(const Input& input) {
+        if constexpr (std::is_array_v<Input>) {
+            if constexpr (std::extent_v<Input> < N) { // Checking the array size
+                return false; // Array too small
+            }
+            run(std::data(input));
+        } else {
+            if (input.size() < N) {
+                return false;
+            }
+            run(input.data());
+        }
+        return true;
+    }
+
+    template<std::size_t Index>
+    inline constexpr std::array<ResultType, N>& output() {
+        static_assert(Index < OutputCount, "Index out of bounds.");
+        return m_outputs[Index];
+    }
+
+private:
+    template<typename T>
+    inline void run(const T* input) {
+        for (reg i = 0; i < N; ++i) {
+            m_root.template run<0>(static_cast<ResultType>(input[i]), m_outputs, i);
+        }
+    }
+
+private:
+    std::array<std::array<ResultType, N>, OutputCount> m_outputs = {};
+    Root m_root;
+};
+
+template<reg N, typename ResultType, typename Root>
+inline TransformTree<N, ResultType, Root> makeTree(Root root) {
+    return TransformTree<N, ResultType, Root>(std::move(root));
+}
+
+#endif /* ___MATH_TRANSFORM_TRANSFORM_TREE_H_ */
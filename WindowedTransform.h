@@ -0,0 +1,122 @@
+/*
+ * WindowedTransform.h
+ *
+ * Sliding-window streaming: windows of Window samples every Hop samples.
+ *
+ * Every incoming sample is run through the element-wise stages exactly once
+ * (pre- and post-Break stages, Break has no meaning here) and stored in a ring
+ * buffer. The ring is mirrored: each sample is written at position p and at
+ * p + Window, so the last Window samples are always contiguous in memory and
+ * each window is handed out as a zero-copy Span. The overlapping Window - Hop
+ * samples are neither copied nor transformed again.
+ *
+ *     WindowedTransform<1024, 256, float, true, Multiply, Add> stream(Multiply(2.0f), Add(1.0f));
+ *     stream.push(samples.data(), samples.size(), [](Span<float> window) { ... });
+ *
+ * The Span passed to onWindow is valid only during that call: the next
+ * windows of the same push() are written over the same ring, so copy what
+ * has to outlive the callback. window() is valid until the next push().
+ */
+
+#ifndef ___MATH_TRANSFORM_WINDOWED_TRANSFORM_H_
+#define ___MATH_TRANSFORM_WINDOWED_TRANSFORM_H_
+
+#include "Transform.h"
+
+template<reg Window, reg Hop, typename ResultType, bool UseFlags = true, typename... Transforms>
+class WindowedTransform {
+    static_assert(Hop > 0 && Hop <= Window, "Hop must be in range [1, Window].");
+
+public:
+    // Only holds the stages and flags, its own buffer is not used
+    using Engine = Transform<1, ResultType, UseFlags, Transforms...>;
+    using FlagsType = typename Engine::FlagsType;
+
+    static_assert(!Engine::HasBlockStages, "Block stages need the whole buffer and cannot run on partial ranges.");
+    static_assert(!Engine::HasIndexedStages, "Indexed stages need frame positions, partial ranges have none.");
+
+    WindowedTransform() = default;
+
+    explicit WindowedTransform(Transforms... transforms) : m_engine(transforms...) {}
+
+    template<std::size_t Index>
+    inline constexpr auto& get() {
+        return m_engine.template get<Index>();
+    }
+
+    inline constexpr void setFlags(const FlagsType& flags) {
+        m_engine.setFlags(flags);
+    }
+
+    // Feeds count samples, calls onWindow(Span<ResultType>) for every completed window
+    template<typename T, typename Callback>
+    reg push(const T* data, reg count, Callback&& onWindow) {
+        reg windows = 0;
+
+        while (count > 0) {
+            // Largest piece that neither wraps the ring nor passes a window boundary
+            reg piece = Window - m_write;
+            if (piece > m_untilWindow) piece = m_untilWindow;
+            if (piece > count) piece = count;
+
+            ResultType* dst = m_buffer.data() + m_write;
+            if constexpr (std::is_same_v<std::remove_cv_t<T>, ResultType>) {
+                std::memcpy(dst, data, piece * sizeof(ResultType));
+            } else {
+                for (reg i = 0; i < piece; ++i) {
+                    dst[i] = static_cast<ResultType>(data[i]);
+                }
+            }
+
+            m_engine.applyBeforeBreak(dst, piece);
+            m_engine.applyAfterBreak(dst, piece);
+            std::memcpy(dst + Window, dst, piece * sizeof(ResultType)); // mirror
+
+            data += piece;
+            count -= piece;
+            m_write += piece;
+            if (m_write == Window) {
+                m_write = 0;
+            }
+
+            m_untilWindow -= piece;
+            if (m_untilWindow == 0) {
+                m_untilWindow = Hop;
+                m_ready = true;
+                ++windows;
+                onWindow(window());
+            }
+        }
+
+        return windows;
+    }
+
+    // Without callback: only the latest window is kept
+    template<typename T>
+    inline reg push(const T* data, reg count) {
+        return push(data, count, [](Span<ResultType>) {});
+    }
+
+    // Most recent Window samples (empty until Window samples were pushed)
+    inline Span<ResultType> window() {
+        if (!m_ready) {
+            return Span<ResultType>();
+        }
+        return Span<ResultType>(m_buffer.data() + m_write, Window);
+    }
+
+    inline constexpr void reset() {
+        m_write = 0;
+        m_untilWindow = Window;
+        m_ready = false;
+    }
+
+private:
+    Engine m_engine;
+    std::array<ResultType, 2 * Window> m_buffer = {};
+    reg m_write = 0;               // next ring position
+    reg m_untilWindow = Window;    // samples until the next window completes
+    bool m_ready = false;
+};
+
+#endif /* ___MATH_TRANSFORM_WINDOWED_TRANSFORM_H_ */
@@ -0,0 +1,46 @@
+#include "envelopeview.h"
+
+#include <QPainter>
+#include <algorithm>
+
+EnvelopeView::EnvelopeView(QWidget *parent)
+    : QWidget(parent)
+{
+    setMinimumSize(320, 200);
+}
+
+void EnvelopeView::setEnvelope(std::vector<Envelope<float>> envelope)
+{
+    m_envelope = std::move(envelope);
+    update();
+}
+
+void EnvelopeView::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().base());
+
+    if (m_envelope.empty()) {
+        return;
+    }
+
+    // Vertical range of the whole envelope
+    float lo = m_envelope.front().min;
+    float hi = m_envelope.front().max;
+    for (const auto &bucket : m_envelope) {
+        lo = std::min(lo, bucket.min);
+        hi = std::max(hi, bucket.max);
+    }
+    const float span = (hi > lo) ? (hi - lo) : 1.0f;
+    const qreal h = height() - 1;
+    const qreal w = width();
+    const qreal step = w / static_cast<qreal>(m_envelope.size());
+
+    painter.setPen(palette().text().color());
+    for (std::size_t i = 0; i < m_envelope.size(); ++i) {
+        const qreal x = (static_cast<qreal>(i) + 0.5) * step;
+        const qreal yMin = h - (m_envelope[i].min - lo) / span * h;
+        const qreal yMax = h - (m_envelope[i].max - lo) / span * h;
+        painter.drawLine(QPointF(x, yMin), QPointF(x, yMax));
+    }
+}
@@ -0,0 +1,25 @@
+#ifndef ENVELOPEVIEW_H
+#define ENVELOPEVIEW_H
+
+#include <QWidget>
+#include <vector>
+#include "Decimate.h"
+
+// Draws a min/max envelope, one vertical line per bucket
+class EnvelopeView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit EnvelopeView(QWidget *parent = nullptr);
+
+    void setEnvelope(std::vector<Envelope<float>> envelope);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    std::vector<Envelope<float>> m_envelope;
+};
+
+#endif // ENVELOPEVIEW_H
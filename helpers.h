@@ -8,10 +8,10 @@
 class Multiply
 {
 public:
-    explicit Multiply(float factor) : m_factor(factor) {}
+    explicit constexpr Multiply(float factor) : m_factor(factor) {}
     Multiply() = default;
 
-    void init (float factor) {
+    constexpr void init (float factor) {
         m_factor = factor;
     }
 
@@ -20,16 +20,16 @@ public:
     }
 
 private:
-    float m_factor;
+    float m_factor = 1.0f;
 };
 
 // Простий трансформатор для додавання
 class Add {
 public:
-    explicit Add(float increment) : m_increment(increment) {}
+    explicit constexpr Add(float increment) : m_increment(increment) {}
     Add() = default;
 
-    void init (float increment) {
+    constexpr void init (float increment) {
         m_increment = increment;
     }
 
@@ -38,7 +38,7 @@ public:
     }
 
 private:
-    float m_increment;
+    float m_increment = 0.0f;
 };
 
 // Трансформатор для квадратного кореня
@@ -2,9 +2,33 @@
 #include "ui_mainwindow.h"
 #include "Transform.h"
 #include "helpers.h"
+#include "Decimate.h"
+#include "envelopeview.h"
+#include <QAction>
+#include <QCoreApplication>
+#include <QMenu>
+#include <QMenuBar>
+#include <QVBoxLayout>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <iostream>
+#include <memory>
+#include <vector>
 #include "test.h"
 
+namespace {
+
+// Decimation demo: 1M samples per frame, one envelope bucket per pixel column,
+// paced to the display rate (a real source would block on acquisition instead)
+constexpr reg DemoSize = 1U << 20;
+constexpr reg DemoWidth = 1024;
+constexpr std::chrono::milliseconds DemoFramePeriod(33);
+
+using DemoTransform = Transform<DemoSize, float, true, Multiply, Add, Break, MinMaxDecimate<DemoSize, DemoWidth>>;
+
+} // namespace
+
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -51,9 +75,80 @@ MainWindow::MainWindow(QWidget *parent)
 
     test();
 
+    // The decimation demo keeps a core busy, so it only runs on request
+    QAction *demo = ui->menubar->addMenu(tr("&Demo"))->addAction(tr("&Decimation"));
+    demo->setCheckable(true);
+    connect(demo, &QAction::toggled, this, [this](bool checked) {
+        if (checked) {
+            startDecimationDemo();
+        } else {
+            stopDecimationDemo();
+        }
+    });
+    if (QCoreApplication::arguments().contains(QStringLiteral("--decimation-demo"))) {
+        demo->setChecked(true);
+    }
 }
 
 MainWindow::~MainWindow()
 {
+    stopDecimationDemo();
     delete ui;
 }
+
+void MainWindow::startDecimationDemo()
+{
+    if (m_worker.joinable()) {
+        return;
+    }
+    if (m_envelopeView == nullptr) {
+        m_envelopeView = new EnvelopeView(ui->centralwidget);
+        auto *layout = new QVBoxLayout(ui->centralwidget);
+        layout->addWidget(m_envelopeView);
+    }
+
+    m_stop = false;
+    m_worker = std::thread([this]() {
+        // Frame is too large for the stack
+        auto transform = std::make_unique<DemoTransform>(Multiply(2.0f), Add(1.0f), Break(), MinMaxDecimate<DemoSize, DemoWidth>());
+        std::vector<float> input(DemoSize);
+        float phase = 0.0f;
+        auto next = std::chrono::steady_clock::now();
+
+        while (!m_stop) {
+            // Frame start at a fixed rate; a late frame does not make the next ones catch up
+            next = std::max(next + DemoFramePeriod, std::chrono::steady_clock::now());
+            std::this_thread::sleep_until(next);
+
+            // Synthetic acquisition: chirp-like sine with some harmonics
+            for (reg i = 0; i < DemoSize; ++i) {
+                const float t = static_cast<float>(i) / DemoSize;
+                input[i] = std::sin(40.0f * t + phase) + 0.25f * std::sin(900.0f * t * t + 3.0f * phase);
+            }
+            phase += 0.05f;
+
+            transform->process(input);
+            transform->results(); // final pass also fills the envelope
+
+            // Drop frames while the GUI is still busy with the previous one
+            if (m_frameInFlight.exchange(true)) {
+                continue;
+            }
+
+            const auto &envelope = transform->get<3>().envelope();
+            std::vector<Envelope<float>> frame(envelope.begin(), envelope.end());
+            QMetaObject::invokeMethod(this, [this, frame = std::move(frame)]() mutable {
+                m_envelopeView->setEnvelope(std::move(frame));
+                m_frameInFlight = false;
+            }, Qt::QueuedConnection);
+        }
+    });
+}
+
+void MainWindow::stopDecimationDemo()
+{
+    m_stop = true;
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+}
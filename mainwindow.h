@@ -2,6 +2,8 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
+#include <atomic>
+#include <thread>
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -9,6 +11,8 @@ class MainWindow;
 }
 QT_END_NAMESPACE
 
+class EnvelopeView;
+
 class MainWindow : public QMainWindow
 {
     Q_OBJECT
@@ -17,7 +21,17 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+private:
+    void startDecimationDemo();
+    void stopDecimationDemo();
+
 private:
     Ui::MainWindow *ui;
+
+    // Decimation demo: processing thread ships only envelopes to the GUI
+    EnvelopeView *m_envelopeView = nullptr;
+    std::thread m_worker;
+    std::atomic<bool> m_stop{false};
+    std::atomic<bool> m_frameInFlight{false};
 };
 #endif // MAINWINDOW_H
@@ -1,9 +1,37 @@
 #include "test.h"
 
 #include "transform.h"
+#include "ChannelBank.h"
+#include "HotSwap.h"
+#include "AsyncTransform.h"
+#include "Decimate.h"
+#include "FileStream.h"
+#include "TransformTree.h"
+#include "DeltaTransform.h"
+#include "WindowedTransform.h"
+#include "BlockStages.h"
+#include "AutoTuner.h"
+#include "TransformParallel.h"
+#include "Quantize.h"
+#include "Predicates.h"
+#include "SnapshotTransform.h"
+#include "SharedRing.h"
+#include "SoaTransform.h"
+#include "Scheduler.h"
+#include "SharedState.h"
+#include "helpers.h"
+#include <algorithm>
+#include <fstream>
 #include <iostream>
+#include <thread>
+#include <cfenv>
+#include <cmath>
+#include <cstdio>
 #include <array>
 #include <vector>
+#if TRANSFORM_SHARED_RING_POSIX
+#include <sys/wait.h>
+#endif /* TRANSFORM_SHARED_RING_POSIX */
 //#include <span>
 
 // Example transformation classes for testing
@@ -167,6 +195,1269 @@ void testFlagsBehavior() {
     std::cout << "All tests passed!" << std::endl;
 }
 
+void testChannelBank() {
+    // Тест банку каналів: кожен канал має власні коефіцієнти і флаги
+    ChannelBank<3, 2, float, true, Multiply, Break, Add> bank(Multiply(2.0f), Break{}, Add(1.0f));
+    bank.get<0>(1).init(3.0f);
+    bank.get<2>(2).init(10.0f);
+    bank.setFlags(0, 0x01); // Канал 0: тільки Multiply
+
+    // Дані перемежовані: кадр 0 (канали 0..2), кадр 1 (канали 0..2)
+    std::array<float, 6> input = {1.0f, 1.0f, 1.0f, 2.0f, 2.0f, 2.0f};
+
+    bool result = bank.process(input);
+    assert(result && "Channel bank process failed");
+    assert(bank.value(1, 1) == 6.0f && "Channel bank result before break check failed");
+
+    auto& finalResults = bank.results();
+    assert((finalResults[0] == std::array<float, 3>{{2.0f, 4.0f, 12.0f}}) && "Channel bank frame 0 check failed");
+    assert((finalResults[1] == std::array<float, 3>{{4.0f, 7.0f, 14.0f}}) && "Channel bank frame 1 check failed");
+
+    // Break на початку: усі стадії після Break, перераховуються для кожного кадру
+    ChannelBank<2, 2, float, true, Break, Add> lazy(Break{}, Add(1.0f));
+    Transform<4, float, true, Break, Add> lazyReference(Break{}, Add(1.0f));
+    lazy.setFlags(0x03);
+    lazyReference.setFlags(0x03);
+    for (float frame : {4.0f, 5.0f}) {
+        std::array<float, 4> values = {frame, frame, frame, frame};
+        lazy.process(values);
+        lazyReference.process(values);
+        assert(lazy.get_array()[0][0] == frame && "Channel bank Break-at-0 before results check failed");
+        assert(lazy.results()[1][1] == frame + 1.0f && lazy.results()[1][1] == lazyReference.results()[3] &&
+               "Channel bank Break-at-0 check failed");
+    }
+
+    // Break у кінці: усе рахує process(), results() нічого не додає
+    ChannelBank<2, 2, float, true, Multiply, Break> eager(Multiply(3.0f), Break{});
+    eager.setFlags(0x03);
+    std::array<float, 4> values = {1.0f, 2.0f, 3.0f, 4.0f};
+    eager.process(values);
+    assert(eager.value(1, 1) == 12.0f && eager.results()[1][1] == 12.0f && "Channel bank Break-at-end check failed");
+    eager.process(values);
+    assert(eager.results()[0][1] == 6.0f && "Channel bank Break-at-end second frame check failed");
+    std::cout << "Channel bank test passed.\n";
+}
+
+void testHotSwap() {
+    // Тест заміни параметрів: Multiply і Add завжди публікуються разом
+    LiveTransform<4, float, true, Multiply, Add> transform(Multiply(2.0f), Add(2.0f));
+    std::array<float, 4> input = {1.0f, 1.0f, 1.0f, 1.0f};
+
+    std::atomic<bool> done{false};
+    std::thread control([&]() {
+        for (int i = 0; i < 2000; ++i) {
+            const float factor = (i & 1) ? 2.0f : 3.0f;
+            transform.stage<0>().init(factor);
+            transform.stage<1>().init(factor);
+            transform.publish();
+        }
+        done = true;
+    });
+
+    // Воркер ніколи не бачить змішаний набір (2 * x + 3 або 3 * x + 2)
+    while (!done) {
+        bool result = transform.process(input);
+        assert(result && "Hot swap process failed");
+        const float value = transform.results()[0];
+        assert((value == 4.0f || value == 6.0f) && "Hot swap observed a half-updated parameter set");
+        (void)value;
+    }
+    control.join();
+
+    transform.setFlags(0x01);
+    transform.publish();
+    transform.process(input);
+    assert((transform.results() == std::array<float, 4>{{2.0f, 2.0f, 2.0f, 2.0f}}) && "Hot swap flags check failed");
+    std::cout << "Hot swap test passed.\n";
+}
+
+// Записує значення у сирий файл
+template<typename T>
+void writeRawFile(const char* path, const std::vector<T>& values) {
+    std::FILE* file = std::fopen(path, "wb");
+    assert(file && "Cannot create test input");
+    std::fwrite(values.data(), sizeof(T), values.size(), file);
+    std::fclose(file);
+}
+
+std::vector<float> readRawFloats(const char* path) {
+    std::vector<float> values;
+    std::FILE* file = std::fopen(path, "rb");
+    if (file == nullptr) {
+        return values;
+    }
+    float value = 0.0f;
+    while (std::fread(&value, sizeof(float), 1, file) == 1) {
+        values.push_back(value);
+    }
+    std::fclose(file);
+    return values;
+}
+
+// Індексований етап: додає позицію елемента в кадрі
+struct AddIndex {
+    float apply(float value, reg index) const {
+        return value + static_cast<float>(index);
+    }
+};
+
+void testFileStream() {
+    // Тест потокової обробки файлів: mmap і буферизований шлях дають той самий результат
+    using Pipeline = Transform<4, float, true, Multiply, Add>;
+    Pipeline pipeline(Multiply(2.0f), Add(1.0f));
+    pipeline.setFlags(0x03);
+
+    const char* inputPath = "file_stream_test.in";
+    const char* outputPath = "file_stream_test.out";
+
+    // 10 кадрів по 4 елементи і ще 2 елементи; порція 3 кадри, остання порція неповна
+    std::vector<float> samples(4 * 10 + 2);
+    for (reg i = 0; i < samples.size(); ++i) {
+        samples[i] = static_cast<float>(i);
+    }
+    writeRawFile(inputPath, samples);
+
+    for (const bool mmap : {true, false}) {
+        FileStream<float, Pipeline> stream(pipeline, 3 * 4 * sizeof(float));
+        stream.setUseMmap(mmap);
+        assert(stream.chunkFrames() == 3 && "Chunk size check failed");
+
+        StreamStats stats;
+        const bool ok = stream.run(inputPath, outputPath, stats);
+        assert(ok && stats.mapped == (mmap && TRANSFORM_FILE_STREAM_POSIX) && "File stream run failed");
+        assert(stats.frames == 10 && stats.tailElements == 2 && "File stream frame count failed");
+        assert(stats.bytesIn == 40 * sizeof(float) && stats.bytesOut == 40 * sizeof(float) && "File stream byte count failed");
+
+        const std::vector<float> output = readRawFloats(outputPath);
+        assert(output.size() == 40 && "File stream output size failed");
+        for (reg i = 0; i < output.size(); ++i) {
+            assert(output[i] == 2.0f * static_cast<float>(i) + 1.0f && "File stream output value failed");
+        }
+        (void)ok;
+    }
+
+    // Етап з індексом: обробка по кадрах, індекс від початку кожного кадру
+    using Indexed = Transform<4, float, true, Multiply, Break, AddIndex>;
+    static_assert(Pipeline::FrameIndependent && !Indexed::FrameIndependent, "Frame independence check failed");
+    Indexed indexed(Multiply(2.0f), Break{}, AddIndex{});
+    for (const bool mmap : {true, false}) {
+        FileStream<float, Indexed> stream(indexed, 3 * 4 * sizeof(float));
+        stream.setUseMmap(mmap);
+        StreamStats stats;
+        const bool ok = stream.run(inputPath, outputPath, stats);
+        const std::vector<float> output = readRawFloats(outputPath);
+        assert(ok && output.size() == 40 && "Indexed stream run failed");
+        for (reg i = 0; i < output.size(); ++i) {
+            assert(output[i] == 2.0f * static_cast<float>(i) + static_cast<float>(i % 4) && "Indexed stream output value failed");
+        }
+        (void)ok;
+    }
+
+    // apply() на місці: те саме, що process() + results(), буфер Transform не змінюється
+    std::array<float, 4> frame = {1.0f, 2.0f, 3.0f, 4.0f};
+    indexed.process(frame);
+    const std::array<float, 4> expected = indexed.results();
+    indexed.apply(frame.data(), frame.size());
+    assert(frame == expected && indexed.results() == expected && "In-place apply check failed");
+
+    // Вхід у форматі int16, перетворення в float перед етапами
+    std::vector<i16> pcm = {-32768, -2, -1, 0, 1, 2, 100, 32767};
+    writeRawFile(inputPath, pcm);
+    for (const bool mmap : {true, false}) {
+        FileStream<i16, Pipeline> stream(pipeline);
+        stream.setUseMmap(mmap);
+        StreamStats stats;
+        const bool ok = stream.run(inputPath, outputPath, stats);
+        const std::vector<float> output = readRawFloats(outputPath);
+        assert(ok && stats.frames == 2 && stats.tailElements == 0 && output.size() == pcm.size() && "I16 stream run failed");
+        for (reg i = 0; i < pcm.size(); ++i) {
+            assert(output[i] == 2.0f * static_cast<float>(pcm[i]) + 1.0f && "I16 stream output value failed");
+        }
+        (void)ok;
+    }
+
+    // Відсутній вхідний файл: помилка на обох шляхах
+    std::remove(inputPath);
+    for (const bool mmap : {true, false}) {
+        FileStream<float, Pipeline> stream(pipeline);
+        stream.setUseMmap(mmap);
+        StreamStats stats;
+        assert(!stream.run(inputPath, outputPath, stats) && stats.frames == 0 && "Missing input should fail");
+    }
+
+    std::remove(outputPath);
+    std::cout << "File stream test passed.\n";
+}
+
+// Стадія зі станом між елементами: сума всіх попередніх значень кадру
+class RunningSum {
+public:
+    float apply(float value) {
+        m_sum += value;
+        return m_sum;
+    }
+
+    void beginFrame() { m_sum = 0.0f; }
+
+private:
+    float m_sum = 0.0f;
+};
+
+void testDecimation() {
+    // Тест децимації: огинаюча min/max збирається в останньому проході
+    Transform<8, float, true, Multiply, Break, MinMaxDecimate<8, 3>> transform(Multiply(2.0f), Break{}, MinMaxDecimate<8, 3>{});
+    std::array<float, 8> input = {1.0f, -3.0f, 2.0f, 5.0f, 0.0f, 4.0f, -1.0f, 7.0f};
+
+    bool result = transform.process(input);
+    assert(result && "Decimation process failed");
+    transform.results();
+
+    // Корзини: [0, 2), [2, 5), [5, 8)
+    const auto& envelope = transform.get<2>().envelope();
+    assert(envelope[0].min == -6.0f && envelope[0].max == 2.0f && "Decimation bucket 0 check failed");
+    assert(envelope[1].min == 0.0f && envelope[1].max == 10.0f && "Decimation bucket 1 check failed");
+    assert(envelope[2].min == -2.0f && envelope[2].max == 14.0f && "Decimation bucket 2 check failed");
+
+    std::array<Envelope<float>, 3> direct = {};
+    decimateMinMax(transform.results().data(), 8, direct.data(), 3);
+    assert(direct[2].min == envelope[2].min && direct[2].max == envelope[2].max && "decimateMinMax check failed");
+
+    auto points = lttb(transform.results().data(), 8, 4);
+    assert(points.size() == 4 && points.front().index == 0 && points.back().index == 7 && "LTTB check failed");
+
+    // Частини кадру в довільному порядку (results(offset, count)): корзини з індексу елемента
+    using Ranged = Transform<1024, float, true, Multiply, Break, MinMaxDecimate<1024, 3>>;
+    static_assert(Ranged::RangedStages && !Ranged::ConstStages, "Indexed decimator should allow ranged results");
+    auto ranged = std::make_unique<Ranged>(Multiply(1.0f), Break{}, MinMaxDecimate<1024, 3>{});
+    std::vector<float> wave(1024);
+    for (reg frame = 0; frame < 2; ++frame) {
+        for (reg i = 0; i < wave.size(); ++i) {
+            wave[i] = std::sin(0.01f * static_cast<float>(i * (frame + 1))) * static_cast<float>(frame + 1);
+        }
+        ranged->process(wave);
+        ranged->results(700, 10);   // корзина 2, потім межа корзин 0/1 всередині блоку 1
+        ranged->results(300, 100);
+        ranged->results(0, 10);
+        ranged->results();
+
+        std::array<Envelope<float>, 3> expected = {};
+        decimateMinMax(wave.data(), wave.size(), expected.data(), 3);
+        const auto& buckets = ranged->get<2>().envelope();
+        for (reg b = 0; b < 3; ++b) {
+            assert(buckets[b].min == expected[b].min && buckets[b].max == expected[b].max && "Ranged decimation check failed");
+        }
+    }
+
+    // Стадія з внутрішнім станом без індексу: results(offset, count) рахує весь кадр по порядку
+    static_assert(!Transform<1024, float, true, Break, RunningSum>::RangedStages, "Stateful stage should force a full compute");
+    auto running = std::make_unique<Transform<1024, float, true, Break, RunningSum>>();
+    running->setFlags(0x03);
+    std::fill(wave.begin(), wave.end(), 1.0f);
+    running->process(wave);
+    assert(running->results(900, 1)[0] == 901.0f && running->results()[0] == 1.0f && "Stateful ranged check failed");
+    std::cout << "Decimation test passed.\n";
+}
+
+void testTransformTree() {
+    // Тест дерева: спільний префікс обчислюється один раз, кожен лист має свій вихід
+    auto tree = makeTree<3, float>(
+        Node(Chain(Multiply(2.0f), Add(2.0f)),
+             Node(Chain()),
+             Node(Chain(Sqrt())),
+             Node(Chain(Multiply(0.5f)),
+                  Node(Chain(Add(1.0f))))));
+    static_assert(decltype(tree)::OutputCount == 3, "Tree output count check failed");
+
+    std::vector<int> input = {1, 7, 17};
+    bool result = tree.process(input);
+    assert(result && "Tree process failed");
+    assert((tree.output<0>() == std::array<float, 3>{{4.0f, 16.0f, 36.0f}}) && "Tree output 0 check failed");
+    assert((tree.output<1>() == std::array<float, 3>{{2.0f, 4.0f, 6.0f}}) && "Tree output 1 check failed");
+    assert((tree.output<2>() == std::array<float, 3>{{3.0f, 9.0f, 19.0f}}) && "Tree output 2 check failed");
+
+    tree.root().chain().get<1>().init(0.0f);
+    tree.process(input);
+    assert((tree.output<0>() == std::array<float, 3>{{2.0f, 14.0f, 34.0f}}) && "Tree stage access check failed");
+    std::cout << "Transform tree test passed.\n";
+}
+
+template<std::size_t Index>
+using IncrementAt = Increment;
+
+template<std::size_t... Indices>
+auto makeLongTransform(std::index_sequence<Indices...>) {
+    return Transform<3, int, true, IncrementAt<Indices>...>();
+}
+
+void testWideFlags() {
+    // Тест довгого конвеєра: більше 32 трансформацій і широка маска флагів
+    auto transform = makeLongTransform(std::make_index_sequence<32>{}).addTransform(Double{});
+    static_assert(decltype(transform)::TransformSize == 33, "Wide transform size check failed");
+    std::array<int, 3> input = {1, 2, 3};
+
+    bool result = transform.process(input);
+    assert(result && "Wide flags process failed");
+    assert((transform.results() == std::array<int, 3>{{66, 68, 70}}) && "Wide flags all-enabled check failed");
+
+    // Тільки Double (індекс 32) і ще один Increment
+    decltype(transform)::FlagsType flags(0);
+    flags.set(32);
+    transform.setFlags(flags);
+    transform.ena(0);
+    transform.process(input);
+    assert((transform.results() == std::array<int, 3>{{4, 6, 8}}) && "Wide flags partial check failed");
+    std::cout << "Wide flags test passed.\n";
+}
+
+void testDeltaTransform() {
+    // Тест дельта-режиму: перераховуються тільки змінені елементи
+    DeltaTransform<200, int, true, Increment, Break, Double> transform(Increment{}, Break{}, Double{});
+    std::vector<int> input(200, 1);
+
+    bool result = transform.process(input);
+    assert(result && "Delta process failed");
+    assert(transform.lastChanged() == 200 && "First delta frame should be dense");
+    assert(transform.get_array()[0] == 2 && transform.results()[199] == 4 && "Delta dense result check failed");
+
+    input[3] = 5;
+    input[150] = 10;
+    transform.process(input);
+    assert(transform.lastChanged() == 2 && "Delta should recompute only changed elements");
+    assert(transform.get_array()[3] == 6 && transform.results()[3] == 12 && "Delta changed element check failed");
+    assert(transform.results()[150] == 22 && transform.results()[151] == 4 && "Delta unchanged element check failed");
+
+    // Багато змін: автоматичний перехід на повний прохід
+    for (auto& value : input) {
+        value += 1;
+    }
+    transform.process(input);
+    assert(transform.lastChanged() == 200 && "Delta should fall back to a dense pass");
+    assert(transform.results()[0] == 6 && "Delta dense fallback result check failed");
+
+    // Зміна флагів інвалідує кеш
+    transform.setFlags(0x01);
+    transform.process(input);
+    assert(transform.lastChanged() == 200 && transform.results()[0] == 3 && "Delta flags change check failed");
+    std::cout << "Delta transform test passed.\n";
+}
+
+void testWindowedTransform() {
+    // Тест ковзного вікна: вікно 4, крок 2, кожен відлік трансформується один раз
+    WindowedTransform<4, 2, int, true, Increment> stream(Increment{});
+    std::vector<int> samples = {0, 1, 2, 3, 4, 5, 6, 7, 8};
+    std::vector<std::vector<int>> windows;
+
+    reg count = stream.push(samples.data(), 5, [&](Span<int> window) {
+        windows.emplace_back(window.begin(), window.end());
+    });
+    count += stream.push(samples.data() + 5, 4, [&](Span<int> window) {
+        windows.emplace_back(window.begin(), window.end());
+    });
+
+    assert(count == 3 && windows.size() == 3 && "Windowed transform window count check failed");
+    assert((windows[0] == std::vector<int>{1, 2, 3, 4}) && "Windowed transform window 0 check failed");
+    assert((windows[1] == std::vector<int>{3, 4, 5, 6}) && "Windowed transform window 1 check failed");
+    assert((windows[2] == std::vector<int>{5, 6, 7, 8}) && "Windowed transform window 2 check failed");
+    assert(stream.window().size() == 4 && stream.window()[0] == 6 && "Windowed transform latest samples check failed");
+
+    // Span вікна дійсний лише під час виклику: наступні вікна того ж push() пишуть у те саме кільце
+    stream.reset();
+    std::vector<int> more = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    Span<int> kept;
+    std::vector<int> copied;
+    stream.push(more.data(), more.size(), [&](Span<int> window) {
+        if (copied.empty()) {
+            kept = window;
+            copied.assign(window.begin(), window.end());
+        }
+    });
+    assert((copied == std::vector<int>{1, 2, 3, 4}) && "Windowed transform first window check failed");
+    assert(!std::equal(copied.begin(), copied.end(), kept.begin()) && "Window Span should be overwritten after the callback");
+    (void)count;
+    std::cout << "Windowed transform test passed.\n";
+}
+
+// FFTMagnitude<N> проти прямого ДПФ на несиметричному сигналі
+template<reg N>
+void checkFFTMagnitude() {
+    std::array<float, N> signal = {};
+    for (reg n = 0; n < N; ++n) {
+        signal[n] = std::sin(0.7f * static_cast<float>(n)) + 0.25f * static_cast<float>(n % 3);
+    }
+    std::array<float, N> spectrum = signal;
+    FFTMagnitude<N>().applyBlock(spectrum.data(), N);
+
+    for (reg k = 0; k < N; ++k) {
+        double re = 0.0;
+        double im = 0.0;
+        for (reg n = 0; n < N; ++n) {
+            const double phase = -2.0 * 3.14159265358979323846 * static_cast<double>(k * n % N) / static_cast<double>(N);
+            re += signal[n] * std::cos(phase);
+            im += signal[n] * std::sin(phase);
+        }
+        const double expected = std::sqrt(re * re + im * im);
+        assert(std::fabs(spectrum[k] - expected) < 1e-4 * (1.0 + expected) && "FFT size check against DFT failed");
+        (void)expected;
+    }
+}
+
+void testBlockStages() {
+    // Тест блочних етапів: вікно, FFT і нормалізація в одному конвеєрі
+    static_assert(HannWindow<8>::Table[0] == 0.0f, "Hann window table check failed");
+    static_assert(std::is_empty_v<FFTMagnitude<1024>>, "FFT should run in place without scratch buffers");
+
+    Transform<16, float, true, Multiply, Break, FFTMagnitude<16>, NormalizePeak<float>> transform(
+        Multiply(1.0f), Break{}, FFTMagnitude<16>{}, NormalizePeak<float>{});
+    std::array<float, 16> input = {};
+    for (reg i = 0; i < 16; ++i) {
+        input[i] = std::cos(2.0f * 3.14159265f * 2.0f * static_cast<float>(i) / 16.0f);
+    }
+
+    bool result = transform.process(input);
+    assert(result && "Block stages process failed");
+    assert(transform.get_array()[0] == 1.0f && "Block stages should run after Break only");
+
+    const auto& spectrum = transform.results();
+    assert(std::fabs(spectrum[2] - 1.0f) < 1e-5f && std::fabs(spectrum[14] - 1.0f) < 1e-5f && "FFT peak bin check failed");
+    assert(std::fabs(spectrum[0]) < 1e-4f && std::fabs(spectrum[5]) < 1e-4f && "FFT empty bin check failed");
+
+    // Непарний сигнал: перевірка дзеркальних бінів і бінів 0 та N/2
+    std::array<float, 8> ramp = {1.0f, 2.0f, 0.0f, -1.0f, 3.0f, 0.5f, -2.0f, 1.0f};
+    std::array<float, 8> spectrum8 = ramp;
+    FFTMagnitude<8>().applyBlock(spectrum8.data(), 8);
+    for (reg k = 0; k < 8; ++k) {
+        float re = 0.0f;
+        float im = 0.0f;
+        for (reg n = 0; n < 8; ++n) {
+            const float phase = -2.0f * 3.14159265f * static_cast<float>(k * n) / 8.0f;
+            re += ramp[n] * std::cos(phase);
+            im += ramp[n] * std::sin(phase);
+        }
+        assert(std::fabs(spectrum8[k] - std::sqrt(re * re + im * im)) < 1e-4f && "FFT bin check against DFT failed");
+    }
+    (void)spectrum;
+
+    // Розміри з парною і непарною кількістю етапів (радикс-4 з радикс-2 першим)
+    checkFFTMagnitude<2>();
+    checkFFTMagnitude<4>();
+    checkFFTMagnitude<32>();
+    checkFFTMagnitude<64>();
+    checkFFTMagnitude<1024>();
+
+    // Флаги вимикають блочний етап так само, як і поелементний
+    transform.setFlags(0x09);
+    transform.process(input);
+    assert(std::fabs(transform.results()[0] - 1.0f) < 1e-6f && "Block stage flags check failed");
+    std::cout << "Block stages test passed.\n";
+}
+
+// Калібрувальна крива, обчислена під час компіляції
+constexpr std::array<float, 8> CalibrationInput = {0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f};
+constexpr auto CalibrationCurve = bakeTable(
+    Transform<4, float, true, Multiply, Break, Add>(Multiply(2.0f), Break{}, Add(1.0f)), CalibrationInput);
+
+constexpr float constexprProcess() {
+    Transform<4, float, false, Multiply, Add> transform(Multiply(3.0f), Add(-1.0f));
+    float input[4] = {1.0f, 2.0f, 3.0f, 4.0f};
+    transform.process(input);
+    return transform.results()[3];
+}
+
+void testConstexprPipeline() {
+    // Тест конвеєра в константних виразах
+    static_assert(CalibrationCurve[0] == 1.0f && CalibrationCurve[7] == 15.0f, "Baked table check failed");
+    static_assert(constexprProcess() == 11.0f, "Constexpr process check failed");
+
+    // Той самий конвеєр під час виконання дає ті самі значення
+    Transform<4, float, true, Multiply, Break, Add> transform(Multiply(2.0f), Break{}, Add(1.0f));
+    std::array<float, 4> input = {4.0f, 5.0f, 6.0f, 7.0f};
+    transform.process(input);
+    for (reg i = 0; i < 4; ++i) {
+        assert(transform.results()[i] == CalibrationCurve[4 + i] && "Runtime/compile-time mismatch");
+    }
+    std::cout << "Constexpr pipeline test passed.\n";
+}
+
+void testAutoTuner() {
+    // Тест стратегій виконання: усі стратегії дають однаковий результат
+    using Pipeline = Transform<1 << 14, float, true, Multiply, Break, Add, Double>;
+    static_assert(Pipeline::supports(ExecStrategy::Threaded), "Const stages should support threads");
+    static_assert(!Transform<16, float, true, FFTMagnitude<16>>::supports(ExecStrategy::Fused), "Block stages cannot be fused");
+
+    auto transform = std::make_unique<Pipeline>(Multiply(2.0f), Break{}, Add(1.0f), Double{});
+    WorkerPool pool(4);
+    attachParallel(*transform, pool);
+    std::vector<float> input(1 << 14);
+    for (reg i = 0; i < input.size(); ++i) {
+        input[i] = static_cast<float>(i % 100);
+    }
+
+    for (const ExecStrategy strategy : TunedStrategies) {
+        transform->setStrategy(strategy);
+        transform->setThreads(4);
+        transform->setFlags(0x0B);  // Add вимкнено
+        transform->process(input);
+        const auto& results = transform->results();
+        assert(transform->strategy() == strategy && "Strategy not set");
+        assert(results[0] == 0.0f && results[99] == 396.0f && results[(1 << 14) - 1] == 4.0f * 83.0f && "Strategy result mismatch");
+        (void)results;
+    }
+    transform->setFlags(Pipeline::FlagsType());
+
+    // Пул потоків живе між кадрами: кожне завдання виконується рівно один раз
+    std::vector<int> hits(64, 0);
+    for (int frame = 0; frame < 100; ++frame) {
+        pool.parallelFor(hits.size(), [&hits](reg index) { ++hits[index]; });
+    }
+    assert(pool.size() == 4 && hits[0] == 100 && hits[63] == 100 && "Worker pool check failed");
+
+    // Перший запуск вимірює, другий читає кеш
+    const char* cacheFile = "transform_tune_test.txt";
+    std::remove(cacheFile);
+    const TuneResult tuned = autoTune(*transform, cacheFile);
+    assert(!tuned.cached && tuned.nanoseconds > 0.0 && "Tuning should measure on the first run");
+    assert(transform->strategy() == tuned.strategy && "Tuned strategy not applied");
+
+    Pipeline::FlagsType flags = transform->flags();
+    transform->setStrategy(ExecStrategy::PerStage);
+    const TuneResult cached = autoTune(*transform, cacheFile);
+    assert(cached.cached && cached.strategy == tuned.strategy && "Cached strategy mismatch");
+    assert(transform->strategy() == tuned.strategy && transform->flags() == flags && "Cached strategy not applied");
+
+    // Повторне налаштування замінює рядок ключа, файл не росте
+    autoTune(*transform, cacheFile, true);
+    autoTune(*transform, cacheFile, true);
+    std::ifstream cache(cacheFile);
+    std::string line;
+    reg lines = 0;
+    while (std::getline(cache, line)) {
+        ++lines;
+    }
+    assert(lines == 1 && "Tuning cache should hold one line per key");
+
+    // Без пулу autoTune не підключає його і обирає лише послідовні стратегії
+    auto serial = std::make_unique<Pipeline>(Multiply(2.0f), Break{}, Add(1.0f), Double{});
+    const TuneResult serialTuned = autoTune(*serial, cacheFile, true);
+    assert(serial->parallelExecutor() == nullptr && "autoTune should not attach a pool");
+    assert((serialTuned.strategy == ExecStrategy::PerStage || serialTuned.strategy == ExecStrategy::Fused) &&
+           "Parallel strategies need an attached pool");
+    (void)tuned; (void)cached; (void)flags; (void)lines; (void)serialTuned;
+    std::remove(cacheFile);
+    std::cout << "Auto tuner test passed.\n";
+}
+
+void testTiledExecution() {
+    // Тест блочного (tiled) виконання: блочний етап між поелементними
+    using Pipeline = Transform<10000, float, true, Multiply, NormalizePeak<float>, Add, Break, Double>;
+    auto tiled = std::make_unique<Pipeline>(Multiply(3.0f), NormalizePeak<float>{}, Add(1.0f), Break{}, Double{});
+    auto reference = std::make_unique<Pipeline>(*tiled);
+    attachParallel(*tiled);
+
+    std::vector<float> input(10000);
+    for (reg i = 0; i < input.size(); ++i) {
+        input[i] = static_cast<float>(i % 50) - 25.0f;
+    }
+
+    tiled->setStrategy(ExecStrategy::Tiled);
+    tiled->setTileSize(1000 + 7);  // остання плитка неповна
+    assert(tiled->strategy() == ExecStrategy::Tiled && tiled->tileSize() == 1007 && "Tiled strategy not set");
+
+    tiled->process(input);
+    reference->process(input);
+    assert(tiled->get_array() == reference->get_array() && "Tiled pre-Break mismatch");
+    assert(tiled->results() == reference->results() && "Tiled post-Break mismatch");
+    assert(tiled->results()[0] == 0.0f && "Tiled normalization check failed");
+
+    tiled->setTileSize(0);
+    assert(effectiveTileSize(*tiled) >= 16 * 1024 / sizeof(float) && "Detected tile size too small");
+    std::cout << "Tiled execution test passed.\n";
+}
+
+void testQuantize() {
+    // Тест квантування: насичення, округлення і упаковка в байтовий буфер
+    std::array<u8, 2 * 16> pcm16 = {};
+    Transform<16, float, true, Multiply, Break, Quantize<SampleFormat::Int16>> transform(
+        Multiply(1.0f), Break{}, Quantize<SampleFormat::Int16>(pcm16.data(), pcm16.size()));
+    std::array<float, 16> input = {0.5f, -1.0f, 1.0f, 2.0f, -3.0f, 0.0f, 1.5f / 32768.0f, 2.5f / 32768.0f,
+                                   -0.25f, 0.75f, 0.1f, -0.1f, 0.0f, 0.0f, 0.0f, 0.0f};
+    transform.process(input);
+    transform.results();
+    auto sample16 = [&](reg i) { return static_cast<i16>(pcm16[2 * i] | (pcm16[2 * i + 1] << 8)); };
+    assert(sample16(0) == 16384 && sample16(1) == -32768 && "Int16 scale check failed");
+    assert(sample16(2) == 32767 && sample16(3) == 32767 && sample16(4) == -32768 && "Int16 saturation check failed");
+    assert(sample16(6) == 2 && sample16(7) == 2 && "Int16 round-to-even check failed");
+    assert(sample16(8) == -8192 && sample16(10) == 3277 && sample16(11) == -3277 && "Int16 value check failed");
+    assert(transform.get<2>().written(16) == 32 && "Int16 byte count check failed");
+
+    // Квантування в тому ж злитому проході, незалежно від режиму округлення FPU
+    using Fused = Transform<16, float, true, Multiply, Break, Quantize<SampleFormat::Int16>>;
+    static_assert(Fused::supports(ExecStrategy::Fused) && Fused::supports(ExecStrategy::Threaded) && Fused::RangedStages,
+                  "Quantize should stay an element stage");
+    std::array<u8, 2 * 16> fused16 = {};
+    Fused fused(Multiply(1.0f), Break{}, Quantize<SampleFormat::Int16>(fused16.data(), fused16.size()));
+    fused.setStrategy(ExecStrategy::Fused);
+    const int mode = std::fegetround();
+    std::fesetround(FE_UPWARD);
+    fused.process(input);
+    fused.results();
+    std::fesetround(mode);
+    assert(fused16 == pcm16 && "Fused quantize / rounding mode check failed");
+
+    // Round toward zero / floor
+    transform.get<2>().setRounding(Rounding::Floor);
+    transform.process(input);
+    transform.results();
+    assert(sample16(6) == 1 && sample16(11) == -3277 && "Floor rounding check failed");
+
+    // 24-біт упаковано по 3 байти, 8-біт і 32-біт
+    std::array<u8, 3 * 4> pcm24 = {};
+    std::array<u8, 4> pcm8 = {};
+    std::array<u8, 4 * 4> pcm32 = {};
+    std::array<float, 4> small = {0.5f, -1.0f, 1.0f, -0.5f};
+    Quantize<SampleFormat::Int24> int24(pcm24.data(), pcm24.size());
+    Quantize<SampleFormat::Int8> int8(pcm8.data(), pcm8.size());
+    Quantize<SampleFormat::Int32> int32(pcm32.data(), pcm32.size() - 1); // останній зразок не вміщається
+    for (reg i = 0; i < small.size(); ++i) {
+        int24.apply(small[i], i);
+        int8.apply(small[i], i);
+        int32.apply(small[i], i);
+    }
+    assert(pcm24[0] == 0x00 && pcm24[1] == 0x00 && pcm24[2] == 0x40 && "Int24 packing check failed");
+    assert(pcm24[5] == 0x80 && pcm24[6] == 0xFF && pcm24[7] == 0xFF && pcm24[8] == 0x7F && "Int24 saturation check failed");
+    assert(pcm8[0] == 64 && pcm8[1] == 0x80 && pcm8[2] == 127 && pcm8[3] == 0xC0 && "Int8 check failed");
+    assert(pcm32[3] == 0x40 && pcm32[7] == 0x80 && pcm32[11] == 0x7F && int32.written(4) == 12 && "Int32 check failed");
+
+    // TPDF дизер: не більше 1 LSB від точного значення
+    std::vector<float> ramp(1000);
+    std::vector<u8> dithered(2 * ramp.size());
+    for (reg i = 0; i < ramp.size(); ++i) {
+        ramp[i] = static_cast<float>(i) / 1000.0f - 0.5f;
+    }
+    Quantize<SampleFormat::Int16> dither(dithered.data(), dithered.size(), Rounding::Nearest, true);
+    dither.beginFrame();
+    for (reg i = 0; i < ramp.size(); ++i) {
+        dither.apply(ramp[i], i);
+    }
+    reg changed = 0;
+    for (reg i = 0; i < ramp.size(); ++i) {
+        const i16 value = static_cast<i16>(dithered[2 * i] | (dithered[2 * i + 1] << 8));
+        const float exact = ramp[i] * 32768.0f;
+        assert(std::fabs(static_cast<float>(value) - exact) <= 1.5f && "Dither amplitude check failed");
+        changed += static_cast<float>(value) != std::nearbyint(exact) ? 1 : 0;
+    }
+    assert(changed > 0 && "Dither should change some samples");
+    (void)changed;
+    std::cout << "Quantize test passed.\n";
+}
+
+void testPredicates() {
+    // Тест умовних етапів без розгалужень
+    Transform<6, float, true, Deadband<float>, Threshold<float>, Clamp<float>> transform(
+        Deadband<float>(0.1f), Threshold<float>(-1.0f, -1.0f), Clamp<float>(-0.5f, 2.0f));
+    std::array<float, 6> input = {0.05f, -0.05f, 0.5f, -3.0f, 5.0f, -0.7f};
+    transform.process(input);
+    assert((transform.results() == std::array<float, 6>{{0.0f, 0.0f, 0.5f, -0.5f, 2.0f, -0.5f}}) && "Clamp/threshold/deadband check failed");
+    static_assert(Transform<6, float, true, Deadband<float>, Threshold<float>, Clamp<float>>::supports(ExecStrategy::Threaded),
+                  "Predicate stages should stay element-wise");
+
+    // Select: різні етапи для двох гілок
+    Select<Greater<float>, Multiply, Add> select(Greater<float>(0.0f), Multiply(10.0f), Add(-1.0f));
+    assert(select.apply(2.0f) == 20.0f && select.apply(-2.0f) == -3.0f && "Select check failed");
+
+    // Маска, обчислена на початку, використовується пізнішим етапом
+    Mask<4> positive;
+    Transform<4, float, true, MakeMask<4, Greater<float>>, Add, Masked<4, Multiply>> masked(
+        MakeMask<4, Greater<float>>(positive, Greater<float>(0.0f)), Add(10.0f), Masked<4, Multiply>(positive, Multiply(2.0f)));
+    std::array<float, 4> values = {1.0f, -1.0f, 2.0f, -2.0f};
+    masked.process(values);
+    assert(positive.count() == 2 && positive[0] == 1 && positive[1] == 0 && "Mask check failed");
+    assert((masked.results() == std::array<float, 4>{{22.0f, 9.0f, 24.0f, 8.0f}}) && "Masked stage check failed");
+
+    // Маскування в тому ж злитому проході і частинами кадру
+    using MaskedPipeline = Transform<512, float, true, MakeMask<512, Greater<float>>, Break, Masked<512, Multiply>>;
+    static_assert(MaskedPipeline::supports(ExecStrategy::Fused) && MaskedPipeline::supports(ExecStrategy::Threaded) &&
+                  MaskedPipeline::RangedStages, "Mask stages should stay element stages");
+    Mask<512> sign;
+    auto fusedMask = std::make_unique<MaskedPipeline>(MakeMask<512, Greater<float>>(sign, Greater<float>(0.0f)), Break{},
+                                                      Masked<512, Multiply>(sign, Multiply(3.0f)));
+    fusedMask->setStrategy(ExecStrategy::Fused);
+    std::vector<float> alternating(512);
+    for (reg i = 0; i < alternating.size(); ++i) {
+        alternating[i] = (i % 2 == 0) ? static_cast<float>(i) : -static_cast<float>(i);
+    }
+    fusedMask->process(alternating);
+    const Span<float> tail = fusedMask->results(300, 4); // лише другий блок
+    assert(sign.count() == 255 && tail[0] == 900.0f && tail[1] == -301.0f && "Fused mask check failed");
+    assert(fusedMask->get_array()[2] == 2.0f && "Masked stage should not run outside the requested range");
+    (void)tail;
+    std::cout << "Predicates test passed.\n";
+}
+
+// Рахує виклики apply(), щоб перевірити одноразове обчислення після Break
+std::atomic<u64> countedApplies{0};
+
+class CountedDouble {
+public:
+    float apply(float value) const {
+        countedApplies.fetch_add(1, std::memory_order_relaxed);
+        return value * 2.0f;
+    }
+};
+
+void testSnapshotTransform() {
+    // Тест знімків: кілька читачів, обчислення після Break рівно один раз на кадр
+    SnapshotTransform<256, float, true, Add, Break, CountedDouble> live(Add(1.0f), Break{}, CountedDouble{});
+    assert(!live.latest() && "No snapshot expected before the first frame");
+
+    std::array<float, 256> input = {};
+    input.fill(1.0f);
+    live.process(input);
+
+    auto first = live.latest();
+    auto copy = first;
+    assert(first.generation() == 1 && first.get_array()[0] == 2.0f && "Snapshot pre-Break check failed");
+    assert(first.results()[255] == 4.0f && copy.results()[0] == 4.0f && "Snapshot results check failed");
+    assert(countedApplies.load() == 256 && "Post-Break stages should run once per frame");
+
+    // Запис нового кадру не змінює утримуваний знімок
+    input.fill(5.0f);
+    live.process(input);
+    assert(first.results()[0] == 4.0f && live.latest().results()[0] == 12.0f && "Held snapshot changed");
+
+    // Усі слоти зайняті читачами: кадр відкидається
+    auto second = live.latest();
+    auto third = (live.process(input), live.latest());
+    auto fourth = (live.process(input), live.latest());
+    assert(!live.process(input) && "Process should fail while every slot is held");
+    first = decltype(first)();
+    copy = decltype(copy)();
+    assert(live.process(input) && "Released slot should be reused");
+    (void)second; (void)third; (void)fourth;
+
+    // Паралельні читачі під час запису
+    countedApplies = 0;
+    std::atomic<bool> done{false};
+    std::atomic<u64> frames{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r) {
+        readers.emplace_back([&] {
+            u64 lastGeneration = 0;
+            while (!done.load(std::memory_order_acquire)) {
+                auto snapshot = live.latest();
+                const auto& results = snapshot.results();
+                const float expected = (static_cast<float>(snapshot.generation() % 100) + 1.0f) * 2.0f;
+                assert(results[0] == expected && results[255] == expected && "Torn snapshot");
+                assert(snapshot.generation() >= lastGeneration && "Generation went backwards");
+                lastGeneration = snapshot.generation();
+                (void)results; (void)expected;
+            }
+        });
+    }
+    u64 published = live.generation();
+    for (int frame = 0; frame < 2000; ++frame) {
+        input.fill(static_cast<float>((published + 1) % 100));
+        if (live.process(input)) {
+            ++published;
+            frames.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    assert(countedApplies.load() % 256 == 0 && countedApplies.load() / 256 <= frames.load() + 1 && "Post-Break computed twice");
+    std::cout << "Snapshot transform test passed.\n";
+}
+
+void testRangeResults() {
+    // Тест обчислення після Break лише для запитаного діапазону
+    auto transform = std::make_unique<Transform<1000, float, true, Add, Break, CountedDouble>>(Add(1.0f), Break{}, CountedDouble{});
+    std::vector<float> input(1000, 1.0f);
+    transform->process(input);
+    countedApplies = 0;
+
+    Span<float> window = transform->results(300, 10);
+    assert(window.size() == 10 && window[0] == 4.0f && countedApplies.load() == 256 && "Range results check failed");
+    assert(transform->get_array()[0] == 2.0f && "Elements outside the range should stay pre-Break");
+
+    transform->results(200, 100);  // лише блок 0, блок 1 вже обчислено
+    assert(countedApplies.load() == 512 && "Overlapping range computed twice");
+
+    transform->results();          // лише пропуски
+    transform->results();
+    assert(countedApplies.load() == 1000 && transform->get_array()[999] == 4.0f && "Gap filling check failed");
+
+    transform->process(input);
+    Span<float> tail = transform->results(990, 100);
+    assert(tail.size() == 10 && tail[9] == 4.0f && countedApplies.load() == 1000 + 232 && "Clipped range check failed");
+    assert(transform->results(1000, 1).size() == 0 && "Range past the end should be empty");
+    (void)window; (void)tail;
+
+    // Break на початку: кожен кадр обчислюється заново
+    Transform<2, float, true, Break, Add> leading(Break{}, Add(1.0f));
+    std::array<float, 2> first = {1.0f, 2.0f};
+    std::array<float, 2> second = {5.0f, 6.0f};
+    leading.process(first);
+    leading.results();
+    leading.process(second);
+    assert(leading.results()[0] == 6.0f && "Leading Break should not keep the previous frame");
+    std::cout << "Range results test passed.\n";
+}
+
+#if TRANSFORM_SHARED_RING_POSIX
+void testSharedRing() {
+    // Тест спільної пам'яті: записувач і читач у різних процесах
+    constexpr reg Frames = 2000;
+    const std::string name = "/transform_ring_test_" + std::to_string(::getpid());
+
+    auto publisher = std::make_unique<SharedRingPublisher<4096, float, true, Multiply, Break, Add>>(Multiply(2.0f), Break{}, Add(1.0f));
+    bool created = publisher->create(name, 4);
+    assert(created && "Shared ring create failed");
+    (void)created;
+
+    // Буфер дочірнього процесу виділяється до fork()
+    std::vector<float> frame(4096);
+    const pid_t child = ::fork();
+    if (child == 0) {
+        // Дочірній процес: без виділень пам'яті, лише системні виклики й атомарні змінні, вихід через _exit
+        SharedRingReader<float> reader;
+        if (!reader.open(name) || reader.frameElements() != frame.size()) {
+            ::_exit(2);
+        }
+        u64 cursor = 0;
+        u64 received = 0;
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(20);
+        while (cursor < Frames && std::chrono::steady_clock::now() < deadline) {
+            const u64 newest = reader.latest();
+            for (u64 f = cursor + 1; f <= newest; ++f) {
+                if (!reader.copy(f, frame.data())) {
+                    continue; // перезаписано, кадр втрачено
+                }
+                const float expected = static_cast<float>(f) * 2.0f + 1.0f;
+                if (frame[0] != expected || frame[4095] != expected) {
+                    ::_exit(3); // розірваний кадр
+                }
+                ++received;
+            }
+            cursor = newest > cursor ? newest : cursor;
+        }
+        ::_exit(cursor == Frames && received > 0 ? 0 : 4);
+    }
+    assert(child > 0 && "fork failed");
+
+    std::vector<float> input(4096);
+    for (reg frame = 1; frame <= Frames; ++frame) {
+        std::fill(input.begin(), input.end(), static_cast<float>(frame));
+        publisher->process(input);
+    }
+    assert(publisher->published() == Frames && "Publisher frame count check failed");
+
+    int status = -1;
+    ::waitpid(child, &status, 0);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0 && "Reader process failed");
+
+    // Читач у тому ж процесі: poll() рахує втрачені кадри
+    SharedRingReader<float> reader;
+    bool opened = reader.open(name);
+    u64 cursor = Frames - 10;
+    u64 lost = 0;
+    const reg read = reader.poll(cursor, [](u64, Span<const float>) {}, &lost);
+    assert(opened && read == 4 && lost == 6 && cursor == Frames && "Poll check failed");
+    assert(!SharedRingReader<double>().open(name) && "Element type mismatch should be rejected");
+
+    // Повторне create() з тим самим ім'ям: новий об'єкт, старе відображення не змінюється
+    SharedRingPublisher<16, float, false, Add> second(Add(0.0f));
+    bool recreated = second.create(name, 2);
+    assert(recreated && reader.frameElements() == 4096 && "Recreate check failed");
+    SharedRingReader<float> fresh;
+    assert(fresh.open(name) && fresh.frameElements() == 16 && "Recreated ring check failed");
+    publisher.reset(); // старий записувач не видаляє ім'я нового кільця
+    SharedRingReader<float> after;
+    assert(after.open(name) && after.frameElements() == 16 && "Old publisher removed the new ring");
+    (void)recreated;
+    (void)status; (void)opened; (void)read;
+    std::cout << "Shared ring test passed.\n";
+}
+#endif /* TRANSFORM_SHARED_RING_POSIX */
+
+void testSoaTransform() {
+    // Тест комплексних і векторних елементів (структура масивів)
+    std::array<std::complex<float>, 4> iq = {{{1.0f, 0.0f}, {0.0f, 2.0f}, {-3.0f, 0.0f}, {0.0f, -4.0f}}};
+
+    // Множення на j, скалярний Multiply на обох компонентах, потім модуль після Break
+    SoaTransform<4, std::complex<float>, true, ComplexMultiply<float>, Multiply, Break, Magnitude> rotate(
+        ComplexMultiply<float>({0.0f, 1.0f}), Multiply(2.0f), Break{}, Magnitude{});
+    rotate.setFlags(0x0F); // Усі флаги активовані
+    assert(rotate.process(iq) && "SoA process failed");
+
+    const std::complex<float> expected[4] = {{0.0f, 2.0f}, {-4.0f, 0.0f}, {0.0f, -6.0f}, {8.0f, 0.0f}};
+    for (reg i = 0; i < 4; ++i) {
+        assert(rotate.value(i) == expected[i] && "Complex multiply check failed");
+    }
+
+    const auto& magnitude = rotate.results();
+    const float magnitudes[4] = {2.0f, 4.0f, 6.0f, 8.0f};
+    for (reg i = 0; i < 4; ++i) {
+        assert(std::fabs(magnitude[0][i] - magnitudes[i]) < 1e-6f && magnitude[1][i] == 0.0f && "Magnitude check failed");
+    }
+
+    // Фаза: поліноміальний atan2 у всіх квадрантах
+    std::array<std::complex<float>, 8> points = {{{1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}, {-1.0f, 2.0f},
+                                                  {-1.0f, 0.0f}, {-2.0f, -1.0f}, {0.5f, -3.0f}, {0.0f, 0.0f}}};
+    SoaTransform<8, std::complex<float>, false, Conjugate, Phase> phase(Conjugate{}, Phase{});
+    phase.process(points);
+    for (reg i = 0; i < 8; ++i) {
+        const float reference = std::atan2(-points[i].imag(), points[i].real());
+        const float angle = phase.results()[0][i];
+        // atan2(-0, -1) = -pi, поліном дає +pi: обидва значення допустимі
+        assert((std::fabs(angle - reference) < 1e-5f || std::fabs(std::fabs(angle) - 3.14159265f) < 1e-5f) && "Phase check failed");
+    }
+
+    // Тривимірні вектори: норма в нульовій компоненті
+    std::vector<Vec<float, 3>> axes(2);
+    axes[0].v = {3.0f, 4.0f, 12.0f};
+    axes[1].v = {1.0f, 2.0f, 2.0f};
+    SoaTransform<2, Vec<float, 3>, false, Magnitude> norm(Magnitude{});
+    assert(norm.process(axes) && "Vec process failed");
+    Vec<float, 3> out[2];
+    norm.copyResults(out);
+    assert(out[0][0] == 13.0f && out[1][0] == 3.0f && out[0][1] == 0.0f && "Vec norm check failed");
+
+    // Модуль на кадрі, що не ділиться на ширину вектора: хвіст теж обчислено, як std::sqrt
+    std::vector<std::complex<double>> odd(11);
+    for (reg i = 0; i < odd.size(); ++i) {
+        odd[i] = {static_cast<double>(i) + 0.5, 1.0 - static_cast<double>(i)};
+    }
+    SoaTransform<11, std::complex<double>, false, Magnitude> oddNorm(Magnitude{});
+    oddNorm.process(odd);
+    for (reg i = 0; i < odd.size(); ++i) {
+        const double re = odd[i].real();
+        const double im = odd[i].imag();
+        assert(oddNorm.results()[0][i] == std::sqrt(re * re + im * im) && "Odd-sized magnitude check failed");
+    }
+
+    // Узагальнена стадія (template T apply(T)) працює покомпонентно, а не над цілим Vec
+    static_assert(!is_element_stage_v<Increment, Vec<int, 3>>, "Generic stages should run per lane");
+    static_assert(is_element_stage_v<ComplexMultiply<float>, std::complex<float>>, "Complex stages should take the element");
+    std::vector<Vec<int, 3>> counters(2);
+    counters[1].v = {1, 2, 3};
+    SoaTransform<2, Vec<int, 3>, false, Increment> increment(Increment{});
+    increment.process(counters);
+    assert((increment.value(0).v == std::array<int, 3>{{1, 1, 1}}) && (increment.value(1).v == std::array<int, 3>{{2, 3, 4}}) &&
+           "Per-lane generic stage check failed");
+
+    std::cout << "SoA transform test passed.\n";
+}
+
+// Вхід, що рахує свої створення: повторно використане завдання лише присвоює його
+struct ScheduledInput {
+    static int created;
+    int value = 0;
+
+    explicit ScheduledInput(int v) : value(v) { ++created; }
+    ScheduledInput(const ScheduledInput& other) : value(other.value) { ++created; }
+    ScheduledInput& operator=(const ScheduledInput&) = default;
+};
+int ScheduledInput::created = 0;
+
+// Конвеєр, що записує порядок запусків і чекає на затвор
+struct OrderedEngine {
+    std::vector<int>* order = nullptr;
+    std::atomic<bool>* gate = nullptr;
+    std::atomic<int>* started = nullptr;
+
+    bool process(const ScheduledInput& input) {
+        started->fetch_add(1);
+        while (!gate->load()) {
+            std::this_thread::yield();
+        }
+        order->push_back(input.value);
+        return true;
+    }
+};
+
+void testScheduler() {
+    // Тест планувальника: кілька конвеєрів різного розміру на спільних потоках
+    Scheduler scheduler(3);
+
+    Transform<4, int, true, Increment, Double> small(Increment{}, Double{});
+    small.setFlags(0x03);
+    Transform<256, float, true, Multiply> large(Multiply(0.5f));
+    large.setFlags(0x01);
+
+    auto& first = scheduler.attach(small, Priority::High);
+    auto& second = scheduler.attach(large, Priority::Background, std::chrono::nanoseconds(1));
+
+    // Завдання одного конвеєра виконуються по черзі, у порядку надходження
+    std::vector<int> order;
+    first.onDone([&order](auto& engine, bool ok) {
+        if (ok) order.push_back(engine.results()[0]);
+    });
+    std::atomic<int> largeDone{0};
+    second.onDone([&largeDone](auto& engine, bool ok) {
+        assert((!ok || engine.results()[255] == 0.5f) && "Large pipeline result check failed");
+        ++largeDone;
+    });
+
+    constexpr int Jobs = 500;
+    std::thread producer([&second]() {
+        std::vector<float> frame(256, 1.0f);
+        for (int i = 0; i < Jobs; ++i) {
+            second.submit(frame);
+        }
+    });
+    for (int i = 0; i < Jobs; ++i) {
+        first.submit(std::array<int, 4>{{i, 0, 0, 0}});
+    }
+    first.submit(std::vector<int>(2)); // замало даних: process() поверне false
+    producer.join();
+    scheduler.wait();
+
+    assert(order.size() == Jobs && "Every job should run once");
+    for (int i = 0; i < Jobs; ++i) {
+        assert(order[i] == 2 * (i + 1) && "Jobs of one pipeline should run in order");
+    }
+    assert(largeDone.load() == Jobs && "Large pipeline job count failed");
+
+    const LatencyStats stats = first.stats();
+    assert(stats.jobs == Jobs + 1 && stats.failed == 1 && stats.missed == 0 && "Stats check failed");
+    assert(stats.maxNs >= stats.percentileNs(0.5) / 2 && stats.meanNs() > 0.0 && "Latency check failed");
+    assert(second.stats().missed == Jobs && "Deadline check failed");
+    (void)stats;
+
+
+    // EDF у межах класу: один потік, перший конвеєр тримає його, поки решта стоїть у черзі
+    Scheduler single(1);
+    std::vector<int> edf;
+    std::atomic<bool> gate{false};
+    std::atomic<int> started{0};
+    OrderedEngine blocker{&edf, &gate, &started}, none{&edf, &gate, &started}, late{&edf, &gate, &started},
+        soon{&edf, &gate, &started}, middle{&edf, &gate, &started};
+    auto& blockerPipeline = single.attach(blocker);
+    auto& nonePipeline = single.attach(none);
+    auto& latePipeline = single.attach(late, Priority::Normal, std::chrono::milliseconds(300));
+    auto& soonPipeline = single.attach(soon, Priority::Normal, std::chrono::milliseconds(10));
+    auto& middlePipeline = single.attach(middle, Priority::Normal, std::chrono::milliseconds(100));
+
+    blockerPipeline.submit(ScheduledInput(0));
+    while (started.load() == 0) {
+        std::this_thread::yield();
+    }
+    nonePipeline.submit(ScheduledInput(4));
+    latePipeline.submit(ScheduledInput(3));
+    soonPipeline.submit(ScheduledInput(1));
+    middlePipeline.submit(ScheduledInput(2));
+    gate.store(true);
+    single.wait();
+    assert((edf == std::vector<int>{0, 1, 2, 3, 4}) && "Earliest deadline should run first, no deadline last");
+
+    // Завдання з пулу: повторний submit присвоює вхід, а не створює нове завдання
+    const ScheduledInput again(5);
+    const int created = ScheduledInput::created;
+    soonPipeline.submit(again);
+    single.wait();
+    assert(ScheduledInput::created == created && edf.back() == 5 && "Finished jobs should be reused");
+    (void)created;
+
+    std::cout << "Scheduler test passed.\n";
+}
+
+// Стадія, що рахує свої копіювання
+int stageCopies = 0;
+
+struct CopyCounted {
+    CopyCounted() = default;
+    CopyCounted(const CopyCounted&) { ++stageCopies; }
+    CopyCounted(CopyCounted&&) noexcept = default;
+    CopyCounted& operator=(const CopyCounted&) { ++stageCopies; return *this; }
+    CopyCounted& operator=(CopyCounted&&) noexcept = default;
+
+    template<typename T>
+    T apply(T value) const { return value; }
+};
+
+void testMoveBuilder() {
+    // Тест збирання конвеєра переміщенням і спільного стану стадій
+    stageCopies = 0;
+    auto built = Transform<4, float, true, CopyCounted>(CopyCounted{})
+                     .addTransform(Multiply(2.0f))
+                     .addTransform(CopyCounted{});
+    assert(stageCopies == 0 && "Rvalue addTransform should move stages");
+
+    auto copied = built.addTransform(Add(1.0f));
+    assert(stageCopies == 2 && "Lvalue addTransform should copy stages");
+    auto moved = std::move(built).addTransform(Add(1.0f));
+    assert(stageCopies == 2 && "std::move addTransform should move stages");
+
+    std::array<float, 4> input = {1.0f, 2.0f, 3.0f, 4.0f};
+    moved.setFlags(0x0F);
+    copied.setFlags(0x0F);
+    moved.process(input);
+    copied.process(input);
+    assert(moved.results() == copied.results() && moved.results()[3] == 9.0f && "Built pipeline check failed");
+
+    // Одна таблиця на два конвеєри
+    auto table = SharedState<LutTable<float>>::make(LutTable<float>::build(1025, 0.0f, 1.0f, [](float x) { return x * x; }));
+    Transform<4, float, true, Lut<float>> first(Lut<float>{table});
+    auto second = first.addTransform(Multiply(2.0f));
+    assert(table.useCount() == 3 && second.get<0>().table().get() == table.get() && "Shared table check failed");
+
+    std::array<float, 4> points = {-1.0f, 0.25f, 0.5f, 2.0f};
+    first.setFlags(0x01);
+    first.process(points);
+    const auto& squares = first.results();
+    assert(squares[0] == 0.0f && squares[3] == 1.0f && "Lut clamp check failed");
+    assert(std::fabs(squares[1] - 0.0625f) < 1e-6f && std::fabs(squares[2] - 0.25f) < 1e-6f && "Lut interpolation check failed");
+
+    std::cout << "Move builder test passed.\n";
+}
+
+#ifdef TRANSFORM_COROUTINES
+// Мінімальна корутина для тестів: запускається одразу, без результату
+struct TestCoroutine {
+    struct promise_type {
+        TestCoroutine get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+using AsyncTestEngine = AsyncTransform<3, int, true, Increment, Break, Double>;
+
+TestCoroutine asyncProcess(AsyncTestEngine& engine, int offset, const CancelSource* cancel, std::atomic<int>& done) {
+    std::array<int, 3> input = {offset, offset + 1, offset + 2};
+    auto result = co_await engine.process_async(input, cancel);
+
+    if (cancel) {
+        assert(result.status == AsyncStatus::Cancelled && "Cancelled request should not run");
+    } else {
+        assert(result && "Async process failed");
+        assert((result.results == std::array<int, 3>{{2 * offset + 2, 2 * offset + 4, 2 * offset + 6}}) && "Async result check failed");
+
+        auto last = co_await engine.results_async();
+        assert(last[0] % 2 == 0 && "Async results check failed");
+    }
+    ++done;
+}
+
+// Стадія-затвор: рахує елементи і тримає виконавця, доки затвор закритий
+struct AsyncGate {
+    std::atomic<int>* elements = nullptr;
+    std::atomic<bool>* open = nullptr;
+
+    int apply(int value) const {
+        elements->fetch_add(1);
+        while (!open->load()) {
+            std::this_thread::yield();
+        }
+        return value;
+    }
+};
+
+using AsyncGateEngine = AsyncTransform<3, int, true, AsyncGate, Break, Double>;
+
+TestCoroutine asyncRequest(AsyncGateEngine& engine, int value, const CancelSource* cancel,
+                           AsyncResult<int, 3>& out, std::atomic<int>& done) {
+    out = co_await engine.process_async(std::array<int, 3>{{value, value, value}}, cancel);
+    ++done;
+}
+
+TestCoroutine asyncShort(AsyncTestEngine& engine, const CancelSource* cancel,
+                         AsyncResult<int, 3>& out, std::atomic<int>& done) {
+    std::vector<int> input = {1}; // коротший за кадр
+    out = co_await engine.process_async(input, cancel);
+    ++done;
+}
+
+TestCoroutine asyncLatest(AsyncGateEngine& engine, std::array<int, 3>& out, std::atomic<int>& done) {
+    out = co_await engine.results_async();
+    ++done;
+}
+
+void testAsyncTransform() {
+    // Тест асинхронної обробки: кілька одночасних запитів і скасування
+    AsyncTestEngine engine(Increment{}, Break{}, Double{});
+    std::atomic<int> done{0};
+
+    CancelSource cancel;
+    cancel.cancel();
+
+    asyncProcess(engine, 1, nullptr, done);
+    asyncProcess(engine, 10, nullptr, done);
+    asyncProcess(engine, 100, &cancel, done);
+
+    while (done.load() < 3) {
+        std::this_thread::yield();
+    }
+
+    // Запити, що чекають за запущеним: одна пачка, скасований у черзі не виконується
+    std::atomic<int> elements{0};
+    std::atomic<bool> open{false};
+    AsyncGateEngine gated(AsyncGate{&elements, &open}, Break{}, Double{});
+
+    // Лічильник елементів у момент відновлення кожної корутини (потік виконавця)
+    std::vector<int> resumedAt;
+    gated.setResumer([&resumedAt, &elements](std::coroutine_handle<> handle) {
+        resumedAt.push_back(elements.load());
+        handle.resume();
+    });
+
+    std::atomic<int> finished{0};
+    AsyncResult<int, 3> first, queued, cancelled, second;
+    std::array<int, 3> latest = {}, latestAgain = {};
+
+    asyncRequest(gated, 1, nullptr, first, finished);
+    while (elements.load() == 0) {
+        std::this_thread::yield(); // перший запит виконується і чекає на затворі
+    }
+
+    CancelSource late;
+    asyncRequest(gated, 2, nullptr, queued, finished);
+    asyncRequest(gated, 3, &late, cancelled, finished);
+    asyncRequest(gated, 4, nullptr, second, finished);
+    asyncLatest(gated, latest, finished);
+    asyncLatest(gated, latestAgain, finished);
+    late.cancel(); // уже в черзі за першим запитом
+    open.store(true);
+
+    while (finished.load() < 6) {
+        std::this_thread::yield();
+    }
+
+    assert(first && (first.results == std::array<int, 3>{{2, 2, 2}}) && "Gated first request check failed");
+    assert(cancelled.status == AsyncStatus::Cancelled && "Queued request should be cancelled");
+    assert(queued && (queued.results == std::array<int, 3>{{4, 4, 4}}) && "Queued request check failed");
+    assert(second && (second.results == std::array<int, 3>{{8, 8, 8}}) && "Second queued request check failed");
+    assert(latest == second.results && latestAgain == second.results && "Batched results check failed");
+    assert(elements.load() == 9 && "Cancelled request should not reach the stages");
+
+    // Перша пачка — лише перший запит; скасований відновлено одразу після неї,
+    // не чекаючи кадрів перед ним; решта чотири — разом після обох кадрів
+    assert(resumedAt.size() == 6 && resumedAt[0] == 3 && "First batch check failed");
+    assert(resumedAt[1] == 3 && "Cancelled request should be resumed before the queue runs");
+    for (reg i = 2; i < resumedAt.size(); ++i) {
+        assert(resumedAt[i] == 9 && "Requests should be batched");
+    }
+
+    // Скасування після виконання не перезаписує статус Failed
+    AsyncTestEngine failing(Increment{}, Break{}, Double{});
+    CancelSource afterRun;
+    failing.setResumer([&afterRun](std::coroutine_handle<> handle) {
+        afterRun.cancel();
+        handle.resume();
+    });
+    AsyncResult<int, 3> failed;
+    std::atomic<int> failedDone{0};
+    asyncShort(failing, &afterRun, failed, failedDone);
+    while (failedDone.load() < 1) {
+        std::this_thread::yield();
+    }
+    assert(failed.status == AsyncStatus::Failed && "Failed request should stay Failed");
+    std::cout << "Async transform test passed.\n";
+}
+#endif /* TRANSFORM_COROUTINES */
 
 
 void test()
@@ -179,5 +1470,30 @@ void test()
     testFlags();
     testBreakBehavior();
     testMySpanInput();
+    testChannelBank();
+    testHotSwap();
+    testFileStream();
+    testDecimation();
+    testTransformTree();
+    testWideFlags();
+    testDeltaTransform();
+    testWindowedTransform();
+    testBlockStages();
+    testConstexprPipeline();
+    testAutoTuner();
+    testTiledExecution();
+    testQuantize();
+    testPredicates();
+    testSnapshotTransform();
+    testRangeResults();
+#if TRANSFORM_SHARED_RING_POSIX
+    testSharedRing();
+#endif /* TRANSFORM_SHARED_RING_POSIX */
+    testSoaTransform();
+    testScheduler();
+    testMoveBuilder();
+#ifdef TRANSFORM_COROUTINES
+    testAsyncTransform();
+#endif /* TRANSFORM_COROUTINES */
     //testFlagsBehavior();
 }